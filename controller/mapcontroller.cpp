@@ -1,5 +1,6 @@
 // mapcontroller.cpp
 #include "mapcontroller.h"
+#include "model/projection.h"
 #include <cmath>
 
 MapController::MapController(MapModel* mapModel, QObject* parent)
@@ -13,37 +14,28 @@ void MapController::setCenter(double lon, double lat)
     _mapModel->setCenter(lon, lat);
 }
 
-void MapController::setZoom(int zoom)
+void MapController::setZoom(double zoom)
 {
     _mapModel->setZoom(zoom);
 }
 
-void MapController::panMap(int deltaX, int deltaY, int zoom)
+void MapController::panMap(int deltaX, int deltaY, double zoom)
 {
-    // Récupérer le centre actuel
-    QPointF center = _mapModel->getCenter();
-    double centerLon = center.x();
-    double centerLat = center.y();
-
-    // Calcul précis pour la conversion pixels -> degrés
-    int n = 1 << zoom;
-    double worldSize = 256.0 * n;
-
-    // Pour la longitude, c'est une relation linéaire
-    double deltaLon = 360.0 * deltaX / worldSize;
+    // Taille du monde en pixels au zoom affiché (fractionnaire pendant le zoom continu)
+    double worldSize = 256.0 * std::pow(2.0, zoom);
 
-    // Pour la latitude, c'est plus complexe à cause de la projection Mercator
-    double latRad = centerLat * M_PI / 180.0;
-    double factor = 1.0 / cos(latRad); // Facteur de correction pour la latitude
-    double deltaLat = -360.0 * deltaY / (worldSize * factor);
+    // Déplacer le centre en pixels du monde : la projection Mercator est exacte à toute latitude
+    QPointF center = _mapModel->getCenter();
+    QPointF world = Projection::lonLatToWorld(center.x(), center.y()) * worldSize + QPointF(deltaX, deltaY);
+    QPointF lonLat = Projection::worldToLonLat(world / worldSize);
 
     // Mettre à jour le centre
-    _mapModel->setCenter(centerLon + deltaLon, centerLat + deltaLat);
+    _mapModel->setCenter(lonLat.x(), lonLat.y());
 }
 
 void MapController::zoomMap(int delta)
 {
-    int currentZoom = _mapModel->getZoom();
+    int currentZoom = _mapModel->getTileZoom();
 
     // Déterminer le nouveau niveau de zoom
     int newZoom = delta > 0 ? currentZoom + 1 : currentZoom - 1;
@@ -51,3 +43,15 @@ void MapController::zoomMap(int delta)
     // Mettre à jour le zoom
     _mapModel->setZoom(newZoom);
 }
+
+void MapController::zoomAround(double zoom, double lon, double lat, double offsetX, double offsetY)
+{
+    zoom = qBound<double>(_mapModel->getMinZoom(), zoom, _mapModel->getMaxZoom());
+    double worldSize = 256.0 * std::pow(2.0, zoom);
+
+    // Le nouveau centre est à l'opposé du décalage du point fixe, au nouveau zoom
+    QPointF anchor = Projection::lonLatToWorld(lon, lat) * worldSize;
+    QPointF center = Projection::worldToLonLat((anchor - QPointF(offsetX, offsetY)) / worldSize);
+
+    _mapModel->setView(center.x(), center.y(), zoom);
+}
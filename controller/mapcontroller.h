@@ -37,23 +37,33 @@ public slots:
 
     /**
      * @brief Définit le niveau de zoom de la carte.
-     * @param zoom Niveau de zoom
+     * @param zoom Niveau de zoom (éventuellement fractionnaire)
      */
-    void setZoom(int zoom);
+    void setZoom(double zoom);
 
     /**
      * @brief Gère le déplacement de la carte.
      * @param deltaX Déplacement horizontal en pixels
      * @param deltaY Déplacement vertical en pixels
-     * @param zoom Niveau de zoom actuel
+     * @param zoom Niveau de zoom actuel (éventuellement fractionnaire)
      */
-    void panMap(int deltaX, int deltaY, int zoom);
+    void panMap(int deltaX, int deltaY, double zoom);
 
     /**
      * @brief Gère le zoom de la carte.
      * @param delta Valeur de la molette (positif pour zoom in, négatif pour zoom out)
      */
     void zoomMap(int delta);
+
+    /**
+     * @brief Change le zoom en gardant un point géographique fixe à l'écran.
+     * @param zoom Nouveau niveau de zoom (éventuellement fractionnaire)
+     * @param lon Longitude du point fixe
+     * @param lat Latitude du point fixe
+     * @param offsetX Décalage horizontal du point fixe par rapport au centre de la vue, en pixels
+     * @param offsetY Décalage vertical du point fixe par rapport au centre de la vue, en pixels
+     */
+    void zoomAround(double zoom, double lon, double lat, double offsetX, double offsetY);
 };
 
 #endif // MAPCONTROLLER_H
@@ -1,4 +1,4 @@
-QT       += core gui network positioning
+QT       += core gui network positioning sql
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -12,16 +12,54 @@ SOURCES += \
     main.cpp \
     mainwindow.cpp \
     view/mapwidget.cpp \
+    view/tilebackbuffer.cpp \
+    view/tilecompositor.cpp \
+    view/minimapwidget.cpp \
+    view/markeratlas.cpp \
     model/placemodel.cpp \
     model/mapmodel.cpp \
+    model/tilecache.cpp \
+    model/tiledatacache.cpp \
+    model/tiledownloader.cpp \
+    model/tilesource.cpp \
+    model/tilelayer.cpp \
+    model/tileengine.cpp \
+    model/markerindex.cpp \
+    model/markerlayer.cpp \
+    model/projection.cpp \
+    model/tiledecoder.cpp \
+    model/tilediskcache.cpp \
+    model/filetilestore.cpp \
+    model/mbtilesstore.cpp \
+    model/tilearchive.cpp \
     controller/searchcontroller.cpp \
     controller/mapcontroller.cpp
 
 HEADERS += \
     mainwindow.h \
     view/mapwidget.h \
+    view/tilebackbuffer.h \
+    view/tilecompositor.h \
+    view/minimapwidget.h \
+    view/markeratlas.h \
     model/placemodel.h \
     model/mapmodel.h \
+    model/tilekey.h \
+    model/tilecache.h \
+    model/tiledatacache.h \
+    model/tiledownloader.h \
+    model/tilesource.h \
+    model/tilelayer.h \
+    model/tileengine.h \
+    model/markerindex.h \
+    model/markerlayer.h \
+    model/projection.h \
+    model/tiledecoder.h \
+    model/tilediskcache.h \
+    model/tilestore.h \
+    model/filetilestore.h \
+    model/mbtilesstore.h \
+    model/tilearchive.h \
     controller/searchcontroller.h \
     controller/mapcontroller.h
 
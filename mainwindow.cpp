@@ -5,6 +5,7 @@
 #include "model/mapmodel.h"
 #include "model/placemodel.h"
 #include "view/mapwidget.h"
+#include "view/minimapwidget.h"
 
 #include <QApplication>
 #include <QGroupBox>
@@ -90,6 +91,10 @@ void MainWindow::createWidgets()
     // Widget pour la carte (utilisant les modèles et contrôleurs)
     _map_widget.reset(new MapWidget(_mapModel.get(), _mapController.get(), _main_widget.get()));
     _map_widget->setMinimumSize(300, 300);
+
+    // Vue d'ensemble, alimentée par les mêmes tuiles que la carte
+    _minimap_widget.reset(new MinimapWidget(_mapModel.get(), _mapController.get(), _main_widget.get()));
+    _minimap_widget->setFixedSize(200, 200);
 }
 
 void MainWindow::setupLayouts()
@@ -103,6 +108,7 @@ void MainWindow::setupLayouts()
     leftLayout->addWidget(_button.get());
     leftLayout->addWidget(_text_edit.get());
     leftLayout->addWidget(_list.get());
+    leftLayout->addWidget(_minimap_widget.get(), 0, Qt::AlignHCenter);
 
     // Ajout des layouts au layout principal
     mainLayout->addLayout(leftLayout);
@@ -139,6 +145,14 @@ void MainWindow::connectSignalsSlots()
 
     // Connexion pour les coordonnées de la souris
     connect(_map_widget.get(), &MapWidget::mousePositionChanged, this, &MainWindow::onMousePositionChanged);
+
+    // Le cadre de la vue d'ensemble suit la taille de la carte
+    connect(_map_widget.get(), &MapWidget::viewSizeChanged, _minimap_widget.get(), &MinimapWidget::setViewSize);
+    _minimap_widget->setViewSize(_map_widget->size());
+
+    // La vue d'ensemble prend ses tuiles dans le moteur de la carte, qui change avec la source
+    connect(_map_widget.get(), &MapWidget::tileEngineChanged, _minimap_widget.get(), &MinimapWidget::setTileEngine);
+    _minimap_widget->setTileEngine(_map_widget->tileEngine());
 }
 
 void MainWindow::onQuitTriggered()
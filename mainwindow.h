@@ -20,6 +20,7 @@ class QMenu;
 class QAction;
 
 class MapWidget;
+class MinimapWidget;
 class PlaceModel;
 class MapModel;
 class SearchController;
@@ -53,6 +54,7 @@ private:
     QScopedPointer<QLineEdit> _text_edit; ///< Champ de texte éditable
     QScopedPointer<QListWidget> _list; ///< Liste des lieux
     QScopedPointer<MapWidget> _map_widget; ///< Widget affichant la carte
+    QScopedPointer<MinimapWidget> _minimap_widget; ///< Vue d'ensemble de la carte, cliquable
     QLabel* _coordsLabel; ///< Label pour afficher les coordonnées dans la barre de statut
 
     // Modèles et contrôleurs
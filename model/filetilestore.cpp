@@ -0,0 +1,121 @@
+// filetilestore.cpp
+#include "filetilestore.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QLocale>
+#include <QSaveFile>
+
+FileTileStore::FileTileStore(const QString& directory)
+    : _directory(directory)
+{
+}
+
+bool FileTileStore::open()
+{
+    return QDir(_directory).mkpath(".");
+}
+
+QHash<TileKey, TileRecord> FileTileStore::index()
+{
+    QHash<TileKey, TileRecord> index;
+    const QFileInfoList files = QDir(_directory).entryInfoList({ "*.png" }, QDir::Files);
+    index.reserve(files.size());
+    for (const QFileInfo& info : files) {
+        TileKey key;
+        if (!parseFileName(info.fileName(), key))
+            continue;
+
+        TileRecord record;
+        record.size = info.size();
+        record.expires = info.lastModified().toSecsSinceEpoch() + TileFreshness::kDefaultMaxAge;
+        record.lastAccess = info.lastRead().toSecsSinceEpoch();
+        index.insert(key, record);
+    }
+    return index;
+}
+
+bool FileTileStore::read(const TileKey& key, StoredTile& tile)
+{
+    QFile file(filePath(_directory, key));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    // Date du dernier téléchargement, au format des dates HTTP
+    QDateTime modified = file.fileTime(QFileDevice::FileModificationTime).toUTC();
+    tile.key = key;
+    tile.data = file.readAll();
+    tile.freshness = TileFreshness();
+    tile.freshness.lastModified = QLocale::c().toString(modified, "ddd, dd MMM yyyy HH:mm:ss 'GMT'").toLatin1();
+    tile.freshness.expires = modified.toSecsSinceEpoch() + TileFreshness::kDefaultMaxAge;
+    return !tile.data.isEmpty();
+}
+
+bool FileTileStore::write(const QVector<StoredTile>& tiles, qint64 now)
+{
+    Q_UNUSED(now);
+
+    bool written = true;
+    for (const StoredTile& tile : tiles) {
+        // Écriture atomique : un lecteur ne voit jamais de fichier partiel
+        QSaveFile file(filePath(_directory, tile.key));
+        written = file.open(QIODevice::WriteOnly) && file.write(tile.data) == tile.data.size() && file.commit()
+            && written;
+    }
+    return written;
+}
+
+bool FileTileStore::updateFreshness(const QVector<StoredTile>& tiles)
+{
+    // La date de modification marque la dernière revalidation
+    QDateTime now = QDateTime::currentDateTimeUtc();
+    bool updated = true;
+    for (const StoredTile& tile : tiles) {
+        QFile file(filePath(_directory, tile.key));
+        updated = file.open(QIODevice::ReadWrite) && file.setFileTime(now, QFileDevice::FileModificationTime)
+            && updated;
+    }
+    return updated;
+}
+
+bool FileTileStore::touch(const QVector<TileKey>& keys, qint64 now)
+{
+    QDateTime accessTime = QDateTime::fromSecsSinceEpoch(now);
+    bool updated = true;
+    for (const TileKey& key : keys) {
+        QFile file(filePath(_directory, key));
+        updated = file.open(QIODevice::ReadWrite) && file.setFileTime(accessTime, QFileDevice::FileAccessTime)
+            && updated;
+    }
+    return updated;
+}
+
+bool FileTileStore::remove(const QVector<TileKey>& keys)
+{
+    bool removed = true;
+    for (const TileKey& key : keys)
+        removed = QFile::remove(filePath(_directory, key)) && removed;
+    return removed;
+}
+
+QString FileTileStore::filePath(const QString& directory, const TileKey& key)
+{
+    return QString("%1/%2-%3-%4.png").arg(directory).arg(key.zoom).arg(key.x).arg(key.y);
+}
+
+bool FileTileStore::parseFileName(const QString& fileName, TileKey& key)
+{
+    // Format du nom : zoom-x-y.png
+    if (!fileName.endsWith(".png"))
+        return false;
+
+    QStringList parts = fileName.chopped(4).split('-');
+    if (parts.size() != 3)
+        return false;
+
+    bool okZoom, okX, okY;
+    key = { parts[0].toInt(&okZoom), parts[1].toInt(&okX), parts[2].toInt(&okY) };
+    return okZoom && okX && okY;
+}
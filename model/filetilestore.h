@@ -0,0 +1,57 @@
+// filetilestore.h
+#ifndef FILETILESTORE_H
+#define FILETILESTORE_H
+
+#include "model/tilestore.h"
+#include <QString>
+
+/**
+ * @class FileTileStore
+ * @brief Stockage des tuiles à raison d'un fichier PNG par tuile.
+ *
+ * Les tuiles sont rangées à plat dans un répertoire, sous le nom
+ * « zoom-x-y.png ». Chaque fichier est écrit de manière atomique
+ * (fichier temporaire puis renommage).
+ *
+ * Aucun fichier annexe n'est créé : la date de modification d'un fichier est
+ * celle de son dernier téléchargement ou de sa dernière revalidation, et
+ * sert de validateur If-Modified-Since ; la tuile reste valide pendant la
+ * durée par défaut. La date d'accès sert à l'éviction LRU.
+ */
+class FileTileStore : public TileStore {
+private:
+    QString _directory; ///< Répertoire des tuiles
+
+public:
+    /**
+     * @brief Constructeur du stockage par fichiers.
+     * @param directory Répertoire des tuiles
+     */
+    explicit FileTileStore(const QString& directory);
+
+    bool open() override;
+    QHash<TileKey, TileRecord> index() override;
+    bool read(const TileKey& key, StoredTile& tile) override;
+    bool write(const QVector<StoredTile>& tiles, qint64 now) override;
+    bool updateFreshness(const QVector<StoredTile>& tiles) override;
+    bool touch(const QVector<TileKey>& keys, qint64 now) override;
+    bool remove(const QVector<TileKey>& keys) override;
+
+    /**
+     * @brief Construit le chemin du fichier d'une tuile.
+     * @param directory Répertoire des tuiles
+     * @param key Identifiant de la tuile
+     * @return Chemin du fichier
+     */
+    static QString filePath(const QString& directory, const TileKey& key);
+
+    /**
+     * @brief Décode l'identifiant d'une tuile à partir du nom de son fichier.
+     * @param fileName Nom du fichier (zoom-x-y.png)
+     * @param key Identifiant décodé
+     * @return Vrai si le nom est celui d'une tuile
+     */
+    static bool parseFileName(const QString& fileName, TileKey& key);
+};
+
+#endif // FILETILESTORE_H
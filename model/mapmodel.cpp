@@ -1,6 +1,15 @@
 // mapmodel.cpp
 #include "mapmodel.h"
 
+#include <cmath>
+
+namespace {
+
+const int kMinZoom = 5; ///< Niveau de zoom minimal
+const int kMaxZoom = 15; ///< Niveau de zoom maximal
+
+} // namespace
+
 MapModel::MapModel(QObject* parent)
     : QObject(parent)
     , _zoom(10)
@@ -22,10 +31,10 @@ void MapModel::setCenter(double lon, double lat)
     }
 }
 
-void MapModel::setZoom(int zoom)
+void MapModel::setZoom(double zoom)
 {
     // Limiter le zoom entre 5 et 15
-    zoom = qBound(5, zoom, 15);
+    zoom = qBound<double>(kMinZoom, zoom, kMaxZoom);
 
     if (_zoom != zoom) {
         _zoom = zoom;
@@ -33,12 +42,45 @@ void MapModel::setZoom(int zoom)
     }
 }
 
+void MapModel::setView(double lon, double lat, double zoom)
+{
+    lon = qBound(-180.0, lon, 180.0);
+    lat = qBound(-85.0, lat, 85.0);
+    zoom = qBound<double>(kMinZoom, zoom, kMaxZoom);
+
+    bool centerMoved = _centerLon != lon || _centerLat != lat;
+    bool zoomMoved = _zoom != zoom;
+    _centerLon = lon;
+    _centerLat = lat;
+    _zoom = zoom;
+
+    if (zoomMoved)
+        emit zoomChanged(zoom);
+    if (centerMoved)
+        emit centerChanged(lon, lat);
+}
+
 QPointF MapModel::getCenter() const
 {
     return QPointF(_centerLon, _centerLat);
 }
 
-int MapModel::getZoom() const
+double MapModel::getZoom() const
 {
     return _zoom;
 }
+
+int MapModel::getTileZoom() const
+{
+    return static_cast<int>(std::floor(_zoom + 0.5));
+}
+
+int MapModel::getMinZoom() const
+{
+    return kMinZoom;
+}
+
+int MapModel::getMaxZoom() const
+{
+    return kMaxZoom;
+}
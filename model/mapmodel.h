@@ -16,7 +16,7 @@ class MapModel : public QObject {
     Q_OBJECT
 
 private:
-    int _zoom; ///< Niveau de zoom de la carte
+    double _zoom; ///< Niveau de zoom de la carte, fractionnaire pendant le zoom continu
     double _centerLon; ///< Longitude du centre de la carte
     double _centerLat; ///< Latitude du centre de la carte
 
@@ -36,9 +36,20 @@ public:
 
     /**
      * @brief Définit le niveau de zoom de la carte.
-     * @param zoom Niveau de zoom
+     * @param zoom Niveau de zoom (éventuellement fractionnaire)
      */
-    void setZoom(int zoom);
+    void setZoom(double zoom);
+
+    /**
+     * @brief Définit le centre et le niveau de zoom en une seule fois.
+     *
+     * Les deux valeurs sont mises à jour avant l'émission des signaux, pour
+     * que la vue ne voie jamais un centre associé au mauvais zoom.
+     * @param lon Longitude du centre
+     * @param lat Latitude du centre
+     * @param zoom Niveau de zoom (éventuellement fractionnaire)
+     */
+    void setView(double lon, double lat, double zoom);
 
     /**
      * @brief Récupère le centre de la carte.
@@ -48,9 +59,30 @@ public:
 
     /**
      * @brief Récupère le niveau de zoom de la carte.
-     * @return Niveau de zoom
+     * @return Niveau de zoom, éventuellement fractionnaire
+     */
+    double getZoom() const;
+
+    /**
+     * @brief Récupère le niveau de tuiles à afficher pour le zoom courant.
+     *
+     * C'est le niveau entier le plus proche : les tuiles sont affichées à une
+     * échelle comprise entre 1/√2 et √2.
+     * @return Niveau de zoom des tuiles
+     */
+    int getTileZoom() const;
+
+    /**
+     * @brief Récupère le niveau de zoom minimal autorisé.
+     * @return Niveau de zoom minimal
+     */
+    int getMinZoom() const;
+
+    /**
+     * @brief Récupère le niveau de zoom maximal autorisé.
+     * @return Niveau de zoom maximal
      */
-    int getZoom() const;
+    int getMaxZoom() const;
 
 signals:
     /**
@@ -62,9 +94,9 @@ signals:
 
     /**
      * @brief Signal émis lorsque le niveau de zoom change.
-     * @param zoom Niveau de zoom
+     * @param zoom Niveau de zoom, éventuellement fractionnaire
      */
-    void zoomChanged(int zoom);
+    void zoomChanged(double zoom);
 };
 
 #endif // MAPMODEL_H
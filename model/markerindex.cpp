@@ -0,0 +1,89 @@
+// markerindex.cpp
+#include "markerindex.h"
+
+#include <algorithm>
+
+void MarkerIndex::insert(const QVector<QPointF>& positions)
+{
+    if (positions.isEmpty())
+        return;
+
+    // Coder les nouveaux points à la suite des anciens
+    const quint32 cells = quint32(1) << kDepth;
+    int previousSize = _entries.size();
+    _entries.reserve(previousSize + positions.size());
+    for (const QPointF& position : positions) {
+        quint32 x = quint32(qBound(0.0, position.x() * cells, cells - 1.0));
+        quint32 y = quint32(qBound(0.0, position.y() * cells, cells - 1.0));
+        _entries.append(Entry { mortonCode(x, y), position });
+    }
+
+    // Trier le lot puis le fusionner avec les points déjà triés
+    auto byCode = [](const Entry& a, const Entry& b) { return a.code < b.code; };
+    auto middle = _entries.begin() + previousSize;
+    std::sort(middle, _entries.end(), byCode);
+    std::inplace_merge(_entries.begin(), middle, _entries.end(), byCode);
+
+    updateSums();
+}
+
+void MarkerIndex::clear()
+{
+    _entries.clear();
+    _sums.clear();
+}
+
+int MarkerIndex::size() const
+{
+    return _entries.size();
+}
+
+QPair<int, int> MarkerIndex::range(int level, quint32 x, quint32 y) const
+{
+    // Les points de la cellule ont tous les codes partageant son préfixe
+    int shift = 2 * (kDepth - level);
+    quint64 first = mortonCode(x, y) << shift;
+    quint64 last = (mortonCode(x, y) + 1) << shift;
+
+    auto below = [](const Entry& entry, quint64 code) { return entry.code < code; };
+    auto begin = std::lower_bound(_entries.begin(), _entries.end(), first, below);
+    auto end = std::lower_bound(begin, _entries.end(), last, below);
+    return qMakePair(int(begin - _entries.begin()), int(end - _entries.begin()));
+}
+
+QPointF MarkerIndex::position(int index) const
+{
+    return _entries.at(index).position;
+}
+
+QPointF MarkerIndex::mean(int first, int last) const
+{
+    if (last <= first)
+        return QPointF();
+    return (_sums.at(last) - _sums.at(first)) / (last - first);
+}
+
+quint64 MarkerIndex::mortonCode(quint32 x, quint32 y)
+{
+    return spreadBits(x) | (spreadBits(y) << 1);
+}
+
+quint64 MarkerIndex::spreadBits(quint32 value)
+{
+    quint64 bits = value;
+    bits = (bits | (bits << 16)) & Q_UINT64_C(0x0000FFFF0000FFFF);
+    bits = (bits | (bits << 8)) & Q_UINT64_C(0x00FF00FF00FF00FF);
+    bits = (bits | (bits << 4)) & Q_UINT64_C(0x0F0F0F0F0F0F0F0F);
+    bits = (bits | (bits << 2)) & Q_UINT64_C(0x3333333333333333);
+    bits = (bits | (bits << 1)) & Q_UINT64_C(0x5555555555555555);
+    return bits;
+}
+
+void MarkerIndex::updateSums()
+{
+    // En double, l'erreur d'arrondi reste sous le centième de pixel au zoom 18 pour un million de points
+    _sums.resize(_entries.size() + 1);
+    _sums[0] = QPointF();
+    for (int i = 0; i < _entries.size(); ++i)
+        _sums[i + 1] = _sums[i] + _entries[i].position;
+}
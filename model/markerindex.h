@@ -0,0 +1,109 @@
+// markerindex.h
+#ifndef MARKERINDEX_H
+#define MARKERINDEX_H
+
+#include <QPair>
+#include <QPointF>
+#include <QVector>
+
+/**
+ * @class MarkerIndex
+ * @brief Index spatial de points en projection Web Mercator (quadtree linéaire).
+ *
+ * Les positions sont exprimées dans le monde normalisé : (0, 0) au coin
+ * nord-ouest, (1, 1) au coin sud-est, soit les coordonnées de tuile au
+ * niveau 0. Chaque point reçoit le code de Morton de sa cellule au niveau
+ * kDepth, et les points sont gardés triés selon ce code.
+ *
+ * Dans cet ordre, les points d'une cellule du quadtree, à n'importe quel
+ * niveau, occupent une plage contiguë trouvée par deux recherches
+ * dichotomiques. Des sommes préfixes des positions donnent le barycentre
+ * d'une cellule sans la parcourir : compter et regrouper les points d'une
+ * cellule coûte O(log n), quel que soit leur nombre.
+ */
+class MarkerIndex {
+public:
+    static const int kDepth = 24; ///< Niveau le plus fin de l'index (cellules plus petites qu'un pixel au zoom 16)
+
+private:
+    /**
+     * @struct Entry
+     * @brief Point de l'index avec son code de Morton.
+     */
+    struct Entry {
+        quint64 code; ///< Code de Morton de la cellule du point au niveau kDepth
+        QPointF position; ///< Position dans le monde normalisé
+    };
+
+    QVector<Entry> _entries; ///< Points triés par code de Morton
+    QVector<QPointF> _sums; ///< Sommes préfixes des positions : _sums[i] cumule les i premiers points
+
+public:
+    /**
+     * @brief Ajoute un lot de points à l'index.
+     *
+     * Le lot est trié puis fusionné avec les points existants : l'ajout coûte
+     * O(n + m log m) pour m nouveaux points. Mieux vaut donc ajouter les
+     * points par lots que un à un.
+     * @param positions Positions dans le monde normalisé
+     */
+    void insert(const QVector<QPointF>& positions);
+
+    /**
+     * @brief Vide l'index.
+     */
+    void clear();
+
+    /**
+     * @brief Récupère le nombre de points de l'index.
+     * @return Nombre de points
+     */
+    int size() const;
+
+    /**
+     * @brief Recherche les points d'une cellule du quadtree.
+     * @param level Niveau de la cellule (0 à kDepth)
+     * @param x Colonne de la cellule à ce niveau
+     * @param y Ligne de la cellule à ce niveau
+     * @return Plage [début, fin) des points de la cellule dans l'ordre de l'index
+     */
+    QPair<int, int> range(int level, quint32 x, quint32 y) const;
+
+    /**
+     * @brief Récupère la position d'un point.
+     * @param index Rang du point dans l'ordre de l'index
+     * @return Position dans le monde normalisé
+     */
+    QPointF position(int index) const;
+
+    /**
+     * @brief Calcule le barycentre d'une plage de points.
+     * @param first Premier point de la plage
+     * @param last Point suivant le dernier de la plage
+     * @return Position moyenne des points, dans le monde normalisé
+     */
+    QPointF mean(int first, int last) const;
+
+    /**
+     * @brief Calcule le code de Morton d'une cellule (entrelacement des bits de x et y).
+     * @param x Colonne de la cellule
+     * @param y Ligne de la cellule
+     * @return Code de Morton
+     */
+    static quint64 mortonCode(quint32 x, quint32 y);
+
+private:
+    /**
+     * @brief Intercale un bit nul entre chacun des 32 bits d'un entier.
+     * @param value Valeur à étaler
+     * @return Valeur étalée sur 64 bits
+     */
+    static quint64 spreadBits(quint32 value);
+
+    /**
+     * @brief Reconstruit les sommes préfixes des positions.
+     */
+    void updateSums();
+};
+
+#endif // MARKERINDEX_H
@@ -0,0 +1,121 @@
+// markerlayer.cpp
+#include "markerlayer.h"
+#include "model/projection.h"
+
+namespace {
+
+const int kCellLevels = 2; ///< Niveaux entre une tuile et une cellule de regroupement (cellules de 64 pixels)
+const int kMaxCachedClusters = 1 << 16; ///< Nombre maximal de cellules gardées pour le niveau courant
+
+} // namespace
+
+MarkerLayer::MarkerLayer(const QColor& color, QObject* parent)
+    : QObject(parent)
+    , _color(color)
+    , _clusterLevel(-1)
+{
+}
+
+void MarkerLayer::setMarkers(const QVector<QPointF>& lonLats)
+{
+    _index.clear();
+    _index.insert(project(lonLats));
+    invalidateClusters();
+}
+
+void MarkerLayer::addMarkers(const QVector<QPointF>& lonLats)
+{
+    _index.insert(project(lonLats));
+    invalidateClusters();
+}
+
+void MarkerLayer::clear()
+{
+    _index.clear();
+    invalidateClusters();
+}
+
+int MarkerLayer::count() const
+{
+    return _index.size();
+}
+
+QColor MarkerLayer::color() const
+{
+    return _color;
+}
+
+void MarkerLayer::setColor(const QColor& color)
+{
+    _color = color;
+    emit changed();
+}
+
+QVector<MarkerCluster> MarkerLayer::clusters(int zoom, int maxZoom, const QRectF& area)
+{
+    QVector<MarkerCluster> result;
+    QRectF world = area.intersected(QRectF(0.0, 0.0, 1.0, 1.0));
+    if (world.isEmpty() || _index.size() == 0)
+        return result;
+
+    // Cellules de la grille couvrant la zone
+    int level = qMin(zoom + kCellLevels, int(MarkerIndex::kDepth));
+    const quint32 cells = quint32(1) << level;
+    quint32 left = quint32(qMin(world.left() * cells, cells - 1.0));
+    quint32 top = quint32(qMin(world.top() * cells, cells - 1.0));
+    quint32 right = quint32(qMin(world.right() * cells, cells - 1.0));
+    quint32 bottom = quint32(qMin(world.bottom() * cells, cells - 1.0));
+
+    // Au niveau le plus proche de la vue, chaque point de la zone est rendu seul
+    if (zoom >= maxZoom) {
+        for (quint32 y = top; y <= bottom; ++y) {
+            for (quint32 x = left; x <= right; ++x) {
+                QPair<int, int> range = _index.range(level, x, y);
+                for (int i = range.first; i < range.second; ++i) {
+                    QPointF position = _index.position(i);
+                    if (world.contains(position))
+                        result.append(MarkerCluster { position, 1 });
+                }
+            }
+        }
+        return result;
+    }
+
+    // Les regroupements gardés ne valent que pour un niveau de grille
+    if (level != _clusterLevel || _clusters.size() > kMaxCachedClusters) {
+        _clusters.clear();
+        _clusterLevel = level;
+    }
+
+    for (quint32 y = top; y <= bottom; ++y) {
+        for (quint32 x = left; x <= right; ++x) {
+            quint64 code = MarkerIndex::mortonCode(x, y);
+            auto it = _clusters.constFind(code);
+            if (it == _clusters.constEnd()) {
+                // Cellule nouvellement visible : un point seul garde sa position exacte
+                QPair<int, int> range = _index.range(level, x, y);
+                int count = range.second - range.first;
+                QPointF position = count == 1 ? _index.position(range.first) : _index.mean(range.first, range.second);
+                it = _clusters.insert(code, MarkerCluster { position, count });
+            }
+            if (it->count > 0)
+                result.append(*it);
+        }
+    }
+    return result;
+}
+
+QVector<QPointF> MarkerLayer::project(const QVector<QPointF>& lonLats)
+{
+    // Projection par lots, vectorisée : c'est l'essentiel du coût d'un chargement de points
+    QVector<QPointF> positions(lonLats.size());
+    Projection::lonLatToWorld(lonLats.constData(), positions.data(), lonLats.size());
+    return positions;
+}
+
+void MarkerLayer::invalidateClusters()
+{
+    _clusters.clear();
+    _clusterLevel = -1;
+    emit changed();
+}
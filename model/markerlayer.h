@@ -0,0 +1,118 @@
+// markerlayer.h
+#ifndef MARKERLAYER_H
+#define MARKERLAYER_H
+
+#include "model/markerindex.h"
+#include <QColor>
+#include <QHash>
+#include <QObject>
+#include <QPointF>
+#include <QRectF>
+#include <QVector>
+
+/**
+ * @struct MarkerCluster
+ * @brief Marqueur à afficher : un point isolé ou un regroupement de points.
+ */
+struct MarkerCluster {
+    QPointF position; ///< Position dans le monde normalisé (barycentre pour un regroupement)
+    int count; ///< Nombre de points représentés
+};
+
+/**
+ * @class MarkerLayer
+ * @brief Calque de marqueurs ponctuels (flotte, équipements), jusqu'au million de points.
+ *
+ * Les points sont rangés dans un index spatial (MarkerIndex). Sous le
+ * niveau de zoom maximal de la vue, ils sont regroupés sur une grille de
+ * cellules de 64 pixels à l'écran : chaque cellule non vide donne un
+ * regroupement placé au barycentre de ses points. Au niveau maximal, les
+ * points sont rendus un à un.
+ *
+ * Les regroupements ne sont calculés que pour les cellules de la zone
+ * demandée, puis gardés pour le niveau courant : un déplacement ne calcule
+ * que les cellules nouvellement visibles, et son coût dépend du nombre de
+ * marqueurs visibles, non de la taille du jeu de données.
+ */
+class MarkerLayer : public QObject {
+    Q_OBJECT
+
+private:
+    MarkerIndex _index; ///< Index spatial des points
+    QColor _color; ///< Couleur des marqueurs du calque
+    int _clusterLevel; ///< Niveau de la grille des regroupements gardés, -1 si aucun
+    QHash<quint64, MarkerCluster> _clusters; ///< Regroupements déjà calculés, par code de Morton de leur cellule
+
+public:
+    /**
+     * @brief Constructeur d'un calque de marqueurs vide.
+     * @param color Couleur des marqueurs
+     * @param parent Objet parent
+     */
+    explicit MarkerLayer(const QColor& color = QColor(33, 150, 243), QObject* parent = nullptr);
+
+    /**
+     * @brief Remplace tous les points du calque.
+     * @param lonLats Positions des points (longitude, latitude)
+     */
+    void setMarkers(const QVector<QPointF>& lonLats);
+
+    /**
+     * @brief Ajoute un lot de points au calque.
+     * @param lonLats Positions des points (longitude, latitude)
+     */
+    void addMarkers(const QVector<QPointF>& lonLats);
+
+    /**
+     * @brief Retire tous les points du calque.
+     */
+    void clear();
+
+    /**
+     * @brief Récupère le nombre de points du calque.
+     * @return Nombre de points
+     */
+    int count() const;
+
+    /**
+     * @brief Récupère la couleur des marqueurs.
+     * @return Couleur des marqueurs
+     */
+    QColor color() const;
+
+    /**
+     * @brief Définit la couleur des marqueurs.
+     * @param color Couleur des marqueurs
+     */
+    void setColor(const QColor& color);
+
+    /**
+     * @brief Récupère les marqueurs à afficher dans une zone.
+     * @param zoom Niveau de zoom des tuiles affichées
+     * @param maxZoom Niveau de zoom maximal de la vue, à partir duquel les points ne sont plus regroupés
+     * @param area Zone du monde normalisé à couvrir
+     * @return Points isolés et regroupements des cellules de la zone
+     */
+    QVector<MarkerCluster> clusters(int zoom, int maxZoom, const QRectF& area);
+
+signals:
+    /**
+     * @brief Signal émis lorsque les points ou la couleur du calque changent.
+     */
+    void changed();
+
+private:
+    /**
+     * @brief Convertit des coordonnées géographiques en position dans le monde normalisé.
+     * @param lonLats Positions (longitude, latitude)
+     * @return Positions en projection Web Mercator, entre 0 et 1
+     */
+    static QVector<QPointF> project(const QVector<QPointF>& lonLats);
+
+    /**
+     * @brief Oublie les regroupements calculés après une modification des points.
+     */
+    void invalidateClusters();
+};
+
+#endif // MARKERLAYER_H
@@ -0,0 +1,322 @@
+// mbtilesstore.cpp
+#include "mbtilesstore.h"
+#include "model/filetilestore.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QPair>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QVariant>
+#include <QVector>
+
+namespace {
+
+const int kImportBatchSize = 512; ///< Nombre de tuiles importées par transaction
+
+} // namespace
+
+MbTilesStore::MbTilesStore(const QString& path, const QString& name, const QString& importDirectory)
+    : _path(path)
+    , _name(name)
+    , _importDirectory(importDirectory)
+    , _connectionName(QString("mbtiles-%1").arg(reinterpret_cast<quintptr>(this)))
+{
+}
+
+MbTilesStore::~MbTilesStore()
+{
+    // La connexion doit être fermée avant d'être retirée
+    {
+        QSqlDatabase db = QSqlDatabase::database(_connectionName, false);
+        if (db.isOpen())
+            db.close();
+    }
+    QSqlDatabase::removeDatabase(_connectionName);
+}
+
+bool MbTilesStore::open()
+{
+    QDir().mkpath(QFileInfo(_path).absolutePath());
+
+    // La connexion appartient au thread qui l'ouvre : celui des entrées/sorties
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", _connectionName);
+    db.setDatabaseName(_path);
+    if (!db.open()) {
+        qDebug() << "Ouverture du stockage de tuiles impossible:" << db.lastError().text();
+        return false;
+    }
+
+    // Journal WAL : les lectures ne sont pas bloquées par les lots d'écriture ;
+    // les pages libérées par l'éviction sont rendues au système (fichiers créés ici)
+    QSqlQuery query(db);
+    query.exec("PRAGMA auto_vacuum=INCREMENTAL");
+    query.exec("PRAGMA journal_mode=WAL");
+    query.exec("PRAGMA synchronous=NORMAL");
+    query.exec("CREATE TABLE IF NOT EXISTS metadata (name TEXT, value TEXT)");
+    query.exec("CREATE TABLE IF NOT EXISTS tiles (zoom_level INTEGER, tile_column INTEGER, "
+               "tile_row INTEGER, tile_data BLOB, etag BLOB, last_modified BLOB, "
+               "expires INTEGER DEFAULT 0, last_access INTEGER DEFAULT 0)");
+    if (!upgradeSchema()
+        || !query.exec("CREATE UNIQUE INDEX IF NOT EXISTS tile_index ON tiles (zoom_level, tile_column, tile_row)")) {
+        qDebug() << "Création du stockage de tuiles impossible:" << query.lastError().text();
+        return false;
+    }
+
+    if (!_importDirectory.isEmpty() && QDir(_importDirectory).exists())
+        importDirectory(_importDirectory);
+
+    // Sans elles, le fichier n'est pas reconnu par les outils MBTiles ; le cache reste utilisable
+    if (!writeMetadata())
+        qDebug() << "Écriture des métadonnées MBTiles impossible:" << _path;
+
+    return true;
+}
+
+QHash<TileKey, TileRecord> MbTilesStore::index()
+{
+    QHash<TileKey, TileRecord> index;
+    QSqlQuery query(QSqlDatabase::database(_connectionName));
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT zoom_level, tile_column, tile_row, length(tile_data), expires, last_access FROM tiles"))
+        return index;
+
+    while (query.next()) {
+        TileKey key { query.value(0).toInt(), query.value(1).toInt(), query.value(2).toInt() };
+        key.y = tmsRow(key);
+
+        TileRecord record;
+        record.size = query.value(3).toLongLong();
+        record.expires = query.value(4).toLongLong();
+        record.lastAccess = query.value(5).toLongLong();
+        index.insert(key, record);
+    }
+    return index;
+}
+
+bool MbTilesStore::read(const TileKey& key, StoredTile& tile)
+{
+    QSqlQuery query(QSqlDatabase::database(_connectionName));
+    query.setForwardOnly(true);
+    query.prepare("SELECT tile_data, etag, last_modified, expires FROM tiles "
+                  "WHERE zoom_level = ? AND tile_column = ? AND tile_row = ?");
+    query.addBindValue(key.zoom);
+    query.addBindValue(key.x);
+    query.addBindValue(tmsRow(key));
+
+    if (!query.exec() || !query.next())
+        return false;
+
+    tile.key = key;
+    tile.data = query.value(0).toByteArray();
+    tile.freshness.etag = query.value(1).toByteArray();
+    tile.freshness.lastModified = query.value(2).toByteArray();
+    tile.freshness.expires = query.value(3).toLongLong();
+    return !tile.data.isEmpty();
+}
+
+bool MbTilesStore::write(const QVector<StoredTile>& tiles, qint64 now)
+{
+    if (tiles.isEmpty())
+        return true;
+
+    // Un lot entier par transaction : une seule synchronisation du journal
+    QSqlDatabase db = QSqlDatabase::database(_connectionName);
+    db.transaction();
+
+    QSqlQuery query(db);
+    query.prepare("INSERT OR REPLACE INTO tiles (zoom_level, tile_column, tile_row, tile_data, etag, "
+                  "last_modified, expires, last_access) VALUES (?, ?, ?, ?, ?, ?, ?, ?)");
+    for (const StoredTile& tile : tiles) {
+        query.addBindValue(tile.key.zoom);
+        query.addBindValue(tile.key.x);
+        query.addBindValue(tmsRow(tile.key));
+        query.addBindValue(tile.data);
+        query.addBindValue(tile.freshness.etag);
+        query.addBindValue(tile.freshness.lastModified);
+        query.addBindValue(tile.freshness.expires);
+        query.addBindValue(now);
+        if (!query.exec()) {
+            qDebug() << "Écriture de tuile impossible:" << query.lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+
+    return db.commit();
+}
+
+bool MbTilesStore::updateFreshness(const QVector<StoredTile>& tiles)
+{
+    if (tiles.isEmpty())
+        return true;
+
+    QSqlDatabase db = QSqlDatabase::database(_connectionName);
+    db.transaction();
+
+    // Un validateur absent de la réponse 304 garde sa valeur (NULL laisse la colonne inchangée)
+    QSqlQuery query(db);
+    query.prepare("UPDATE tiles SET etag = COALESCE(?, etag), last_modified = COALESCE(?, last_modified), "
+                  "expires = ? WHERE zoom_level = ? AND tile_column = ? AND tile_row = ?");
+    for (const StoredTile& tile : tiles) {
+        query.addBindValue(tile.freshness.etag.isEmpty() ? QVariant() : QVariant(tile.freshness.etag));
+        query.addBindValue(tile.freshness.lastModified.isEmpty() ? QVariant() : QVariant(tile.freshness.lastModified));
+        query.addBindValue(tile.freshness.expires);
+        query.addBindValue(tile.key.zoom);
+        query.addBindValue(tile.key.x);
+        query.addBindValue(tmsRow(tile.key));
+        if (!query.exec()) {
+            db.rollback();
+            return false;
+        }
+    }
+
+    return db.commit();
+}
+
+bool MbTilesStore::touch(const QVector<TileKey>& keys, qint64 now)
+{
+    if (keys.isEmpty())
+        return true;
+
+    QSqlDatabase db = QSqlDatabase::database(_connectionName);
+    db.transaction();
+
+    QSqlQuery query(db);
+    query.prepare("UPDATE tiles SET last_access = ? WHERE zoom_level = ? AND tile_column = ? AND tile_row = ?");
+    for (const TileKey& key : keys) {
+        query.addBindValue(now);
+        query.addBindValue(key.zoom);
+        query.addBindValue(key.x);
+        query.addBindValue(tmsRow(key));
+        if (!query.exec()) {
+            db.rollback();
+            return false;
+        }
+    }
+
+    return db.commit();
+}
+
+bool MbTilesStore::remove(const QVector<TileKey>& keys)
+{
+    if (keys.isEmpty())
+        return true;
+
+    QSqlDatabase db = QSqlDatabase::database(_connectionName);
+    db.transaction();
+
+    QSqlQuery query(db);
+    query.prepare("DELETE FROM tiles WHERE zoom_level = ? AND tile_column = ? AND tile_row = ?");
+    for (const TileKey& key : keys) {
+        query.addBindValue(key.zoom);
+        query.addBindValue(key.x);
+        query.addBindValue(tmsRow(key));
+        if (!query.exec()) {
+            db.rollback();
+            return false;
+        }
+    }
+
+    if (!db.commit())
+        return false;
+
+    // Rendre au système les pages libérées, pour que l'occupation du disque suive le quota
+    query.exec("PRAGMA incremental_vacuum");
+    return true;
+}
+
+int MbTilesStore::importDirectory(const QString& directory)
+{
+    QDir dir(directory);
+    const QStringList names = dir.entryList({ "*.png" }, QDir::Files);
+
+    int imported = 0;
+    QVector<StoredTile> batch;
+    QStringList batchFiles;
+    batch.reserve(kImportBatchSize);
+
+    auto flush = [&]() {
+        // Les fichiers ne sont supprimés qu'une fois leur lot validé
+        if (write(batch, QDateTime::currentSecsSinceEpoch())) {
+            for (const QString& name : qAsConst(batchFiles))
+                dir.remove(name);
+            imported += batch.size();
+        }
+        batch.clear();
+        batchFiles.clear();
+    };
+
+    for (const QString& name : names) {
+        TileKey key;
+        if (!FileTileStore::parseFileName(name, key))
+            continue;
+
+        QFile file(dir.filePath(name));
+        if (!file.open(QIODevice::ReadOnly))
+            continue;
+
+        // Fraîcheur inconnue : la tuile importée sera revalidée à sa première lecture
+        batch.append({ key, file.readAll(), TileFreshness() });
+        batchFiles.append(name);
+        if (batch.size() == kImportBatchSize)
+            flush();
+    }
+    flush();
+
+    // Supprimer le répertoire s'il ne reste plus rien dedans
+    if (dir.isEmpty())
+        dir.removeRecursively();
+
+    return imported;
+}
+
+bool MbTilesStore::writeMetadata()
+{
+    QSqlQuery query(QSqlDatabase::database(_connectionName));
+    if (!query.exec("CREATE UNIQUE INDEX IF NOT EXISTS metadata_index ON metadata (name)"))
+        return false;
+
+    // Lignes exigées par le format, puis niveaux de zoom présents s'il y a des tuiles
+    QVector<QPair<QString, QString>> rows = { qMakePair(QString("name"), _name), qMakePair(QString("format"), QString("png")) };
+    if (query.exec("SELECT MIN(zoom_level), MAX(zoom_level) FROM tiles") && query.next() && !query.isNull(0)) {
+        rows.append(qMakePair(QString("minzoom"), query.value(0).toString()));
+        rows.append(qMakePair(QString("maxzoom"), query.value(1).toString()));
+    }
+
+    query.prepare("INSERT OR REPLACE INTO metadata (name, value) VALUES (?, ?)");
+    for (const QPair<QString, QString>& row : qAsConst(rows)) {
+        query.addBindValue(row.first);
+        query.addBindValue(row.second);
+        if (!query.exec())
+            return false;
+    }
+    return true;
+}
+
+bool MbTilesStore::upgradeSchema()
+{
+    QSqlDatabase db = QSqlDatabase::database(_connectionName);
+    QSqlRecord columns = db.record("tiles");
+
+    const QStringList added = { "etag BLOB", "last_modified BLOB", "expires INTEGER DEFAULT 0",
+        "last_access INTEGER DEFAULT 0" };
+    QSqlQuery query(db);
+    for (const QString& column : added) {
+        if (columns.contains(column.section(' ', 0, 0)))
+            continue;
+        if (!query.exec(QString("ALTER TABLE tiles ADD COLUMN %1").arg(column)))
+            return false;
+    }
+    return true;
+}
+
+int MbTilesStore::tmsRow(const TileKey& key)
+{
+    return (1 << key.zoom) - 1 - key.y;
+}
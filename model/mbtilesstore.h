@@ -0,0 +1,88 @@
+// mbtilesstore.h
+#ifndef MBTILESSTORE_H
+#define MBTILESSTORE_H
+
+#include "model/tilestore.h"
+#include <QString>
+
+/**
+ * @class MbTilesStore
+ * @brief Stockage des tuiles dans un seul fichier SQLite au format MBTiles.
+ *
+ * Toutes les tuiles tiennent dans une table indexée par (zoom, colonne,
+ * ligne) : une lecture est une recherche dans l'index, et un lot d'écritures
+ * est validé en une seule transaction. Comme le veut le format MBTiles, les
+ * lignes sont numérotées depuis le sud (schéma TMS).
+ *
+ * La table metadata reçoit les lignes exigées par le format (name, format)
+ * et les niveaux de zoom présents, mis à jour à chaque ouverture : le
+ * fichier s'ouvre dans les outils MBTiles usuels.
+ *
+ * La table des tuiles porte aussi, dans des colonnes supplémentaires
+ * ignorées des autres lecteurs MBTiles, les validateurs HTTP, la fin de
+ * validité et le dernier accès de chaque tuile.
+ *
+ * À l'ouverture, les tuiles d'un ancien répertoire « un fichier par tuile »
+ * peuvent être importées ; les fichiers importés sont alors supprimés.
+ */
+class MbTilesStore : public TileStore {
+private:
+    QString _path; ///< Chemin du fichier MBTiles
+    QString _name; ///< Nom du jeu de tuiles, enregistré dans les métadonnées
+    QString _importDirectory; ///< Ancien répertoire de tuiles à importer, vide sinon
+    QString _connectionName; ///< Nom de la connexion SQLite, propre à cette instance
+
+public:
+    /**
+     * @brief Constructeur du stockage MBTiles.
+     * @param path Chemin du fichier MBTiles
+     * @param name Nom du jeu de tuiles (nom de la source)
+     * @param importDirectory Répertoire de tuiles PNG à importer à l'ouverture (facultatif)
+     */
+    MbTilesStore(const QString& path, const QString& name, const QString& importDirectory = QString());
+
+    /**
+     * @brief Destructeur : ferme la connexion SQLite.
+     */
+    ~MbTilesStore() override;
+
+    bool open() override;
+    QHash<TileKey, TileRecord> index() override;
+    bool read(const TileKey& key, StoredTile& tile) override;
+    bool write(const QVector<StoredTile>& tiles, qint64 now) override;
+    bool updateFreshness(const QVector<StoredTile>& tiles) override;
+    bool touch(const QVector<TileKey>& keys, qint64 now) override;
+    bool remove(const QVector<TileKey>& keys) override;
+
+    /**
+     * @brief Importe les tuiles d'un répertoire « un fichier par tuile ».
+     *
+     * Les tuiles sont insérées par lots ; les fichiers d'un lot validé sont
+     * supprimés, puis le répertoire s'il est vide.
+     * @param directory Répertoire des tuiles PNG
+     * @return Nombre de tuiles importées
+     */
+    int importDirectory(const QString& directory);
+
+private:
+    /**
+     * @brief Enregistre les métadonnées MBTiles : nom, format et niveaux de zoom présents.
+     * @return Vrai si les métadonnées ont été écrites
+     */
+    bool writeMetadata();
+
+    /**
+     * @brief Ajoute à une table créée par une version précédente les colonnes de fraîcheur.
+     * @return Vrai si la table a toutes ses colonnes
+     */
+    bool upgradeSchema();
+
+    /**
+     * @brief Convertit une ligne de tuile XYZ en ligne TMS, et inversement.
+     * @param key Identifiant de la tuile
+     * @return Ligne comptée depuis le sud
+     */
+    static int tmsRow(const TileKey& key);
+};
+
+#endif // MBTILESSTORE_H
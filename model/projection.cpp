@@ -0,0 +1,214 @@
+// projection.cpp
+#include "projection.h"
+
+#include <QtGlobal>
+#include <QtMath>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PROJECTION_SSE2
+#endif
+
+namespace {
+
+const double kDegreesToRadians = M_PI / 180.0; ///< Conversion des degrés en radians
+const double kExponentBias = 4503599627370496.0 + 2048.0; ///< 2^52 plus le décalage du champ d'exposant reconstruit
+const quint64 kSqrtHalfBits = Q_UINT64_C(0x3FE6A09E667F3BCD); ///< Représentation binaire de √½
+const quint64 kExponentMask = Q_UINT64_C(0xFFF0000000000000); ///< Signe et exposant d'un double
+const quint64 kTwoPow52Bits = Q_UINT64_C(0x4330000000000000); ///< Représentation binaire de 2^52
+
+/// Coefficients de la série de sin(x) en x², du degré 17 au degré 1 (erreur < 2e-14 pour |x| ≤ 85°)
+const double kSinCoefficients[] = { 1.0 / 355687428096000.0, -1.0 / 1307674368000.0, 1.0 / 6227020800.0,
+    -1.0 / 39916800.0, 1.0 / 362880.0, -1.0 / 5040.0, 1.0 / 120.0, -1.0 / 6.0, 1.0 };
+
+/// Coefficients de la série d'atanh(u) en u², du degré 21 au degré 1 (erreur < 1e-17 pour |u| ≤ 0,172)
+const double kAtanhCoefficients[] = { 1.0 / 21, 1.0 / 19, 1.0 / 17, 1.0 / 15, 1.0 / 13, 1.0 / 11,
+    1.0 / 9, 1.0 / 7, 1.0 / 5, 1.0 / 3, 1.0 };
+
+/**
+ * @brief Calcule la longitude normalisée.
+ * @param lon Longitude
+ * @return Abscisse dans le monde normalisé
+ */
+inline double worldX(double lon)
+{
+    return (lon + 180.0) * (1.0 / 360.0);
+}
+
+/**
+ * @brief Calcule l'ordonnée Mercator normalisée, sans branche ni appel de fonction.
+ *
+ * y = 1/2 - ln((1 + sin φ) / (1 - sin φ)) / 4π. Le logarithme est calculé
+ * par extraction de l'exposant (ramenant la mantisse entre √½ et √2) puis
+ * par la série ln(m) = 2 atanh((m - 1) / (m + 1)).
+ * @param lat Latitude
+ * @return Ordonnée dans le monde normalisé
+ */
+inline double worldY(double lat)
+{
+    // Bornage sans comparaison : ½ (|φ + max| - |φ - max|)
+    lat = 0.5 * (std::fabs(lat + Projection::kMaxLatitude) - std::fabs(lat - Projection::kMaxLatitude));
+
+    double x = lat * kDegreesToRadians;
+    double x2 = x * x;
+    double sine = kSinCoefficients[0];
+    for (int i = 1; i < int(sizeof(kSinCoefficients) / sizeof(double)); ++i)
+        sine = sine * x2 + kSinCoefficients[i];
+    sine *= x;
+
+    double ratio = (1.0 + sine) / (1.0 - sine);
+    quint64 bits;
+    std::memcpy(&bits, &ratio, sizeof(bits));
+    quint64 offset = bits - kSqrtHalfBits;
+    quint64 exponentBits = kTwoPow52Bits | (((offset >> 52) + 0x800) & 0xFFF);
+    quint64 mantissaBits = bits - (offset & kExponentMask);
+    double exponent;
+    double mantissa;
+    std::memcpy(&exponent, &exponentBits, sizeof(exponent));
+    std::memcpy(&mantissa, &mantissaBits, sizeof(mantissa));
+    exponent -= kExponentBias;
+
+    double u = (mantissa - 1.0) / (mantissa + 1.0);
+    double u2 = u * u;
+    double atanh = kAtanhCoefficients[0];
+    for (int i = 1; i < int(sizeof(kAtanhCoefficients) / sizeof(double)); ++i)
+        atanh = atanh * u2 + kAtanhCoefficients[i];
+    atanh *= u;
+
+    return 0.5 - (exponent * M_LN2 + 2.0 * atanh) * (0.25 / M_PI);
+}
+
+#ifdef PROJECTION_SSE2
+
+/**
+ * @brief Calcule la longitude normalisée de deux points.
+ * @param lon Longitudes
+ * @return Abscisses dans le monde normalisé
+ */
+inline __m128d worldX2(__m128d lon)
+{
+    return _mm_mul_pd(_mm_add_pd(lon, _mm_set1_pd(180.0)), _mm_set1_pd(1.0 / 360.0));
+}
+
+/**
+ * @brief Calcule l'ordonnée Mercator normalisée de deux points (voir worldY()).
+ * @param lat Latitudes
+ * @return Ordonnées dans le monde normalisé
+ */
+inline __m128d worldY2(__m128d lat)
+{
+    const __m128d signMask = _mm_set1_pd(-0.0);
+    const __m128d maxLatitude = _mm_set1_pd(Projection::kMaxLatitude);
+    __m128d above = _mm_andnot_pd(signMask, _mm_add_pd(lat, maxLatitude));
+    __m128d below = _mm_andnot_pd(signMask, _mm_sub_pd(lat, maxLatitude));
+    lat = _mm_mul_pd(_mm_set1_pd(0.5), _mm_sub_pd(above, below));
+
+    __m128d x = _mm_mul_pd(lat, _mm_set1_pd(kDegreesToRadians));
+    __m128d x2 = _mm_mul_pd(x, x);
+    __m128d sine = _mm_set1_pd(kSinCoefficients[0]);
+    for (int i = 1; i < int(sizeof(kSinCoefficients) / sizeof(double)); ++i)
+        sine = _mm_add_pd(_mm_mul_pd(sine, x2), _mm_set1_pd(kSinCoefficients[i]));
+    sine = _mm_mul_pd(sine, x);
+
+    const __m128d one = _mm_set1_pd(1.0);
+    __m128d ratio = _mm_div_pd(_mm_add_pd(one, sine), _mm_sub_pd(one, sine));
+    __m128i bits = _mm_castpd_si128(ratio);
+    __m128i offset = _mm_sub_epi64(bits, _mm_set1_epi64x(qint64(kSqrtHalfBits)));
+    __m128i field = _mm_and_si128(_mm_add_epi64(_mm_srli_epi64(offset, 52), _mm_set1_epi64x(0x800)),
+        _mm_set1_epi64x(0xFFF));
+    __m128d exponent = _mm_sub_pd(_mm_castsi128_pd(_mm_or_si128(field, _mm_set1_epi64x(qint64(kTwoPow52Bits)))),
+        _mm_set1_pd(kExponentBias));
+    __m128d mantissa = _mm_castsi128_pd(
+        _mm_sub_epi64(bits, _mm_and_si128(offset, _mm_set1_epi64x(qint64(kExponentMask)))));
+
+    __m128d u = _mm_div_pd(_mm_sub_pd(mantissa, one), _mm_add_pd(mantissa, one));
+    __m128d u2 = _mm_mul_pd(u, u);
+    __m128d atanh = _mm_set1_pd(kAtanhCoefficients[0]);
+    for (int i = 1; i < int(sizeof(kAtanhCoefficients) / sizeof(double)); ++i)
+        atanh = _mm_add_pd(_mm_mul_pd(atanh, u2), _mm_set1_pd(kAtanhCoefficients[i]));
+    atanh = _mm_mul_pd(atanh, u);
+
+    __m128d logRatio = _mm_add_pd(_mm_mul_pd(exponent, _mm_set1_pd(M_LN2)), _mm_add_pd(atanh, atanh));
+    return _mm_sub_pd(_mm_set1_pd(0.5), _mm_mul_pd(logRatio, _mm_set1_pd(0.25 / M_PI)));
+}
+
+#endif // PROJECTION_SSE2
+
+} // namespace
+
+QPointF Projection::lonLatToWorld(double lon, double lat)
+{
+    return QPointF(worldX(lon), worldY(lat));
+}
+
+QPointF Projection::worldToLonLat(const QPointF& world)
+{
+    double lon = world.x() * 360.0 - 180.0;
+    double lat = qRadiansToDegrees(std::atan(std::sinh(M_PI * (1.0 - 2.0 * world.y()))));
+    return QPointF(lon, lat);
+}
+
+QPointF Projection::lonLatToTile(double lon, double lat, double zoom)
+{
+    return lonLatToWorld(lon, lat) * std::pow(2.0, zoom);
+}
+
+QPointF Projection::tileToLonLat(const QPointF& tile, double zoom)
+{
+    return worldToLonLat(tile / std::pow(2.0, zoom));
+}
+
+void Projection::lonLatToWorld(const double* lon, const double* lat, double* x, double* y, int count)
+{
+    int i = 0;
+#ifdef PROJECTION_SSE2
+    for (; i + 2 <= count; i += 2) {
+        __m128d worldLon = worldX2(_mm_loadu_pd(lon + i));
+        __m128d worldLat = worldY2(_mm_loadu_pd(lat + i));
+        _mm_storeu_pd(x + i, worldLon);
+        _mm_storeu_pd(y + i, worldLat);
+    }
+#endif
+
+    // Fin du lot, ou lot entier sans SSE2
+    for (; i < count; ++i) {
+        double worldLat = worldY(lat[i]);
+        x[i] = worldX(lon[i]);
+        y[i] = worldLat;
+    }
+}
+
+void Projection::lonLatToWorld(const QPointF* lonLats, QPointF* world, int count)
+{
+    int i = 0;
+#ifdef PROJECTION_SSE2
+    // QPointF est une paire de doubles contiguë : deux points forment deux registres (lon, lat)
+    static_assert(sizeof(QPointF) == 2 * sizeof(double), "QPointF doit contenir deux doubles");
+    for (; i + 2 <= count; i += 2) {
+        const double* in = reinterpret_cast<const double*>(lonLats + i);
+        __m128d first = _mm_loadu_pd(in);
+        __m128d second = _mm_loadu_pd(in + 2);
+        __m128d x = worldX2(_mm_unpacklo_pd(first, second));
+        __m128d y = worldY2(_mm_unpackhi_pd(first, second));
+
+        double* out = reinterpret_cast<double*>(world + i);
+        _mm_storeu_pd(out, _mm_unpacklo_pd(x, y));
+        _mm_storeu_pd(out + 2, _mm_unpackhi_pd(x, y));
+    }
+#endif
+
+    // Fin du lot, ou lot entier sans SSE2
+    for (; i < count; ++i)
+        world[i] = lonLatToWorld(lonLats[i].x(), lonLats[i].y());
+}
+
+void Projection::worldToLonLat(const double* x, const double* y, double* lon, double* lat, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        QPointF lonLat = worldToLonLat(QPointF(x[i], y[i]));
+        lon[i] = lonLat.x();
+        lat[i] = lonLat.y();
+    }
+}
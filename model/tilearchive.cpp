@@ -0,0 +1,170 @@
+// tilearchive.cpp
+#include "tilearchive.h"
+
+#include <QSaveFile>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+
+namespace {
+
+const char kMagic[8] = { 'O', 'S', 'M', 'T', 'P', 'A', 'C', 'K' }; ///< Signature du fichier
+const quint32 kVersion = 1; ///< Version du format
+const int kHeaderSize = 16; ///< Taille de l'en-tête en octets
+const int kEntrySize = 24; ///< Taille d'une entrée d'index en octets
+
+/**
+ * @brief Compare un identifiant de tuile à une entrée d'index, dans l'ordre (zoom, x, y).
+ * @return Négatif, nul ou positif selon que la tuile précède, égale ou suit l'entrée
+ */
+int compareEntry(const TileKey& key, const uchar* entry)
+{
+    const quint32 fields[3] = { quint32(key.zoom), quint32(key.x), quint32(key.y) };
+    for (int i = 0; i < 3; i++) {
+        quint32 value = qFromLittleEndian<quint32>(entry + 4 * i);
+        if (fields[i] != value)
+            return fields[i] < value ? -1 : 1;
+    }
+    return 0;
+}
+
+} // namespace
+
+TileArchive::TileArchive()
+    : _data(nullptr)
+    , _size(0)
+    , _count(0)
+{
+}
+
+TileArchive::~TileArchive()
+{
+    close();
+}
+
+bool TileArchive::open(const QString& path)
+{
+    close();
+
+    _file.setFileName(path);
+    if (!_file.open(QIODevice::ReadOnly))
+        return false;
+
+    // Projection partagée en lecture seule : aucune lecture tant qu'une page n'est pas touchée
+    _size = _file.size();
+    _data = _size >= kHeaderSize ? _file.map(0, _size) : nullptr;
+    if (!_data) {
+        close();
+        return false;
+    }
+
+    // Vérifier l'en-tête et que l'index tient dans le fichier
+    _count = qFromLittleEndian<quint32>(_data + 12);
+    bool valid = std::memcmp(_data, kMagic, sizeof(kMagic)) == 0
+        && qFromLittleEndian<quint32>(_data + 8) == kVersion
+        && kHeaderSize + qint64(_count) * kEntrySize <= _size;
+    if (!valid) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void TileArchive::close()
+{
+    if (_data)
+        _file.unmap(const_cast<uchar*>(_data));
+    _file.close();
+    _data = nullptr;
+    _size = 0;
+    _count = 0;
+}
+
+bool TileArchive::isOpen() const
+{
+    return _data != nullptr;
+}
+
+int TileArchive::tileCount() const
+{
+    return static_cast<int>(_count);
+}
+
+bool TileArchive::contains(const TileKey& key) const
+{
+    return findEntry(key) != nullptr;
+}
+
+QByteArray TileArchive::find(const TileKey& key) const
+{
+    const uchar* entry = findEntry(key);
+    if (!entry)
+        return QByteArray();
+
+    quint32 size = qFromLittleEndian<quint32>(entry + 12);
+    quint64 offset = qFromLittleEndian<quint64>(entry + 16);
+    if (offset > quint64(_size) || size > quint64(_size) - offset)
+        return QByteArray();
+
+    // Aucune copie : le tableau référence directement les pages projetées
+    return QByteArray::fromRawData(reinterpret_cast<const char*>(_data + offset), static_cast<int>(size));
+}
+
+bool TileArchive::write(const QString& path, QVector<StoredTile> tiles)
+{
+    std::sort(tiles.begin(), tiles.end(), [](const StoredTile& a, const StoredTile& b) {
+        return std::make_tuple(a.key.zoom, a.key.x, a.key.y) < std::make_tuple(b.key.zoom, b.key.x, b.key.y);
+    });
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    uchar header[kHeaderSize];
+    std::memcpy(header, kMagic, sizeof(kMagic));
+    qToLittleEndian<quint32>(kVersion, header + 8);
+    qToLittleEndian<quint32>(quint32(tiles.size()), header + 12);
+    file.write(reinterpret_cast<const char*>(header), kHeaderSize);
+
+    // Les données suivent l'index, dans le même ordre
+    quint64 offset = kHeaderSize + quint64(tiles.size()) * kEntrySize;
+    for (const StoredTile& tile : qAsConst(tiles)) {
+        uchar entry[kEntrySize];
+        qToLittleEndian<quint32>(quint32(tile.key.zoom), entry);
+        qToLittleEndian<quint32>(quint32(tile.key.x), entry + 4);
+        qToLittleEndian<quint32>(quint32(tile.key.y), entry + 8);
+        qToLittleEndian<quint32>(quint32(tile.data.size()), entry + 12);
+        qToLittleEndian<quint64>(offset, entry + 16);
+        file.write(reinterpret_cast<const char*>(entry), kEntrySize);
+        offset += tile.data.size();
+    }
+
+    for (const StoredTile& tile : qAsConst(tiles))
+        file.write(tile.data);
+
+    return file.commit();
+}
+
+const uchar* TileArchive::findEntry(const TileKey& key) const
+{
+    if (!_data)
+        return nullptr;
+
+    // Dichotomie sur l'index trié : une vingtaine de comparaisons pour un million de tuiles
+    const uchar* index = _data + kHeaderSize;
+    quint32 low = 0;
+    quint32 high = _count;
+    while (low < high) {
+        quint32 middle = low + (high - low) / 2;
+        const uchar* entry = index + qint64(middle) * kEntrySize;
+        int order = compareEntry(key, entry);
+        if (order == 0)
+            return entry;
+        if (order < 0)
+            high = middle;
+        else
+            low = middle + 1;
+    }
+    return nullptr;
+}
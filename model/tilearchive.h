@@ -0,0 +1,104 @@
+// tilearchive.h
+#ifndef TILEARCHIVE_H
+#define TILEARCHIVE_H
+
+#include "model/tilekey.h"
+#include "model/tilestore.h"
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+/**
+ * @class TileArchive
+ * @brief Archive de tuiles pré-rendues, en lecture seule, projetée en mémoire.
+ *
+ * Le fichier est projeté en mémoire d'un seul bloc : l'ouverture ne lit que
+ * l'en-tête, quelle que soit la taille de l'archive, et les pages sont
+ * partagées avec les autres processus par le cache du système.
+ *
+ * Format (entiers petit-boutistes) :
+ * - en-tête de 16 octets : « OSMTPACK », version (32 bits), nombre de tuiles (32 bits) ;
+ * - index trié par (zoom, x, y), 24 octets par tuile : zoom, x, y, taille
+ *   (32 bits chacun) puis position des données dans le fichier (64 bits) ;
+ * - données PNG des tuiles, contiguës.
+ *
+ * Les données renvoyées par find() pointent directement dans la projection :
+ * elles restent valides tant que l'archive est ouverte.
+ */
+class TileArchive {
+private:
+    QFile _file; ///< Fichier de l'archive
+    const uchar* _data; ///< Début de la projection en mémoire, nul si l'archive est fermée
+    qint64 _size; ///< Taille du fichier en octets
+    quint32 _count; ///< Nombre de tuiles de l'index
+
+public:
+    /**
+     * @brief Constructeur d'une archive fermée.
+     */
+    TileArchive();
+
+    /**
+     * @brief Destructeur : libère la projection en mémoire.
+     */
+    ~TileArchive();
+
+    /**
+     * @brief Ouvre une archive et la projette en mémoire.
+     * @param path Chemin de l'archive
+     * @return Vrai si l'archive est valide et ouverte
+     */
+    bool open(const QString& path);
+
+    /**
+     * @brief Ferme l'archive.
+     *
+     * Les données renvoyées par find() ne doivent plus être utilisées.
+     */
+    void close();
+
+    /**
+     * @brief Indique si une archive est ouverte.
+     * @return Vrai si une archive est ouverte
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Récupère le nombre de tuiles de l'archive.
+     * @return Nombre de tuiles
+     */
+    int tileCount() const;
+
+    /**
+     * @brief Vérifie si une tuile est dans l'archive.
+     * @param key Identifiant de la tuile
+     * @return Vrai si la tuile est présente
+     */
+    bool contains(const TileKey& key) const;
+
+    /**
+     * @brief Recherche une tuile, sans copie.
+     * @param key Identifiant de la tuile
+     * @return Données PNG pointant dans la projection, vides si la tuile est absente
+     */
+    QByteArray find(const TileKey& key) const;
+
+    /**
+     * @brief Écrit une archive à partir d'un ensemble de tuiles.
+     * @param path Chemin de l'archive à créer
+     * @param tiles Tuiles à archiver
+     * @return Vrai si l'archive a été écrite
+     */
+    static bool write(const QString& path, QVector<StoredTile> tiles);
+
+private:
+    /**
+     * @brief Recherche par dichotomie l'entrée d'index d'une tuile.
+     * @param key Identifiant de la tuile
+     * @return Entrée d'index, nulle si la tuile est absente
+     */
+    const uchar* findEntry(const TileKey& key) const;
+};
+
+#endif // TILEARCHIVE_H
@@ -0,0 +1,60 @@
+// tilecache.cpp
+#include "tilecache.h"
+
+#include <climits>
+
+TileCache::TileCache(qint64 maxBytes)
+{
+    setMaxBytes(maxBytes);
+}
+
+void TileCache::setMaxBytes(qint64 maxBytes)
+{
+    // QCache compte le coût en int : on travaille en Kio pour dépasser 2 Go
+    _cache.setMaxCost(static_cast<int>(qBound<qint64>(1, maxBytes / 1024, INT_MAX)));
+}
+
+qint64 TileCache::maxBytes() const
+{
+    return qint64(_cache.maxCost()) * 1024;
+}
+
+qint64 TileCache::usedBytes() const
+{
+    return qint64(_cache.totalCost()) * 1024;
+}
+
+void TileCache::insert(const TileKey& key, const QImage& tile)
+{
+    if (tile.isNull())
+        return;
+
+    _cache.insert(key, new QImage(tile), costOf(tile));
+}
+
+QImage TileCache::find(const TileKey& key)
+{
+    QImage* tile = _cache.object(key);
+    return tile ? *tile : QImage();
+}
+
+bool TileCache::contains(const TileKey& key) const
+{
+    return _cache.contains(key);
+}
+
+void TileCache::remove(const TileKey& key)
+{
+    _cache.remove(key);
+}
+
+void TileCache::clear()
+{
+    _cache.clear();
+}
+
+int TileCache::costOf(const QImage& tile)
+{
+    qint64 bytes = tile.sizeInBytes() + qint64(tile.colorCount()) * sizeof(QRgb);
+    return static_cast<int>(qMax<qint64>(1, bytes / 1024));
+}
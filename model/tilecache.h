@@ -0,0 +1,96 @@
+// tilecache.h
+#ifndef TILECACHE_H
+#define TILECACHE_H
+
+#include "model/tilekey.h"
+#include <QCache>
+#include <QImage>
+
+/**
+ * @class TileCache
+ * @brief Cache mémoire des tuiles décodées, borné en octets.
+ *
+ * Les tuiles sont gardées dans le format compact issu du décodage : une
+ * tuile PNG à palette reste en Format_Indexed8, soit 64 Kio plus la palette
+ * au lieu de 256 Kio en ARGB32. Le même budget contient ainsi jusqu'à
+ * quatre fois plus de tuiles ; seules les tuiles visibles sont converties
+ * pour l'affichage.
+ *
+ * Les tuiles sont indexées par leur identifiant (zoom, x, y) et évincées
+ * selon la politique LRU (la moins récemment utilisée) dès que le budget
+ * mémoire est dépassé.
+ */
+class TileCache {
+private:
+    QCache<TileKey, QImage> _cache; ///< Tuiles indexées par identifiant, coût en Kio
+
+public:
+    /**
+     * @brief Constructeur du cache de tuiles.
+     * @param maxBytes Budget mémoire en octets
+     */
+    explicit TileCache(qint64 maxBytes = 256 * 1024 * 1024);
+
+    /**
+     * @brief Définit le budget mémoire du cache.
+     *
+     * Les tuiles les moins récemment utilisées sont évincées si le nouveau
+     * budget est inférieur à l'occupation actuelle.
+     * @param maxBytes Budget mémoire en octets
+     */
+    void setMaxBytes(qint64 maxBytes);
+
+    /**
+     * @brief Récupère le budget mémoire du cache.
+     * @return Budget mémoire en octets
+     */
+    qint64 maxBytes() const;
+
+    /**
+     * @brief Récupère la mémoire occupée par les tuiles en cache.
+     * @return Occupation en octets
+     */
+    qint64 usedBytes() const;
+
+    /**
+     * @brief Ajoute ou remplace une tuile dans le cache.
+     * @param key Identifiant de la tuile
+     * @param tile Tuile décodée, dans son format compact
+     */
+    void insert(const TileKey& key, const QImage& tile);
+
+    /**
+     * @brief Recherche une tuile et la marque comme récemment utilisée.
+     * @param key Identifiant de la tuile
+     * @return La tuile, ou une image nulle si elle est absente
+     */
+    QImage find(const TileKey& key);
+
+    /**
+     * @brief Vérifie si une tuile est présente sans modifier l'ordre LRU.
+     * @param key Identifiant de la tuile
+     * @return Vrai si la tuile est en cache
+     */
+    bool contains(const TileKey& key) const;
+
+    /**
+     * @brief Retire une tuile du cache.
+     * @param key Identifiant de la tuile
+     */
+    void remove(const TileKey& key);
+
+    /**
+     * @brief Vide le cache.
+     */
+    void clear();
+
+private:
+    /**
+     * @brief Calcule le coût d'une tuile en Kio, palette comprise.
+     * @param tile Tuile décodée
+     * @return Coût de la tuile
+     */
+    static int costOf(const QImage& tile);
+};
+
+#endif // TILECACHE_H
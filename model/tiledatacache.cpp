@@ -0,0 +1,55 @@
+// tiledatacache.cpp
+#include "tiledatacache.h"
+
+#include <climits>
+
+TileDataCache::TileDataCache(qint64 maxBytes)
+{
+    setMaxBytes(maxBytes);
+}
+
+void TileDataCache::setMaxBytes(qint64 maxBytes)
+{
+    // Les données sont petites : le coût est compté en octets, dans la limite d'un int
+    _maxBytes = qBound<qint64>(1, maxBytes, INT_MAX);
+    _cache.setMaxCost(static_cast<int>(_maxBytes));
+}
+
+qint64 TileDataCache::maxBytes() const
+{
+    return _maxBytes;
+}
+
+qint64 TileDataCache::usedBytes() const
+{
+    return _cache.totalCost();
+}
+
+void TileDataCache::insert(const TileKey& key, const QByteArray& data)
+{
+    if (data.isEmpty())
+        return;
+
+    _cache.insert(key, new QByteArray(data), data.size());
+}
+
+QByteArray TileDataCache::find(const TileKey& key)
+{
+    QByteArray* data = _cache.object(key);
+    return data ? *data : QByteArray();
+}
+
+bool TileDataCache::contains(const TileKey& key) const
+{
+    return _cache.contains(key);
+}
+
+void TileDataCache::remove(const TileKey& key)
+{
+    _cache.remove(key);
+}
+
+void TileDataCache::clear()
+{
+    _cache.clear();
+}
@@ -0,0 +1,83 @@
+// tiledatacache.h
+#ifndef TILEDATACACHE_H
+#define TILEDATACACHE_H
+
+#include "model/tilekey.h"
+#include <QByteArray>
+#include <QCache>
+
+/**
+ * @class TileDataCache
+ * @brief Cache mémoire des données compressées (PNG) des tuiles, borné en octets.
+ *
+ * Niveau intermédiaire entre le cache des tuiles décodées et le cache
+ * disque : une tuile PNG occupe de 10 à 20 Kio, contre 64 à 256 Kio une
+ * fois décodée. Des quartiers entiers restent ainsi en mémoire et sont
+ * décodés en arrière-plan à la demande, sans lecture sur le disque.
+ *
+ * Les tuiles sont évincées selon la politique LRU.
+ */
+class TileDataCache {
+private:
+    QCache<TileKey, QByteArray> _cache; ///< Données indexées par identifiant, coût en octets
+    qint64 _maxBytes; ///< Budget mémoire en octets
+
+public:
+    /**
+     * @brief Constructeur du cache de données.
+     * @param maxBytes Budget mémoire en octets
+     */
+    explicit TileDataCache(qint64 maxBytes = 128 * 1024 * 1024);
+
+    /**
+     * @brief Définit le budget mémoire du cache.
+     * @param maxBytes Budget mémoire en octets (au plus 2 Gio)
+     */
+    void setMaxBytes(qint64 maxBytes);
+
+    /**
+     * @brief Récupère le budget mémoire du cache.
+     * @return Budget mémoire en octets
+     */
+    qint64 maxBytes() const;
+
+    /**
+     * @brief Récupère la mémoire occupée par les données en cache.
+     * @return Occupation en octets
+     */
+    qint64 usedBytes() const;
+
+    /**
+     * @brief Ajoute ou remplace les données d'une tuile.
+     * @param key Identifiant de la tuile
+     * @param data Données PNG de la tuile
+     */
+    void insert(const TileKey& key, const QByteArray& data);
+
+    /**
+     * @brief Recherche les données d'une tuile et les marque comme récemment utilisées.
+     * @param key Identifiant de la tuile
+     * @return Les données, ou un tableau vide si la tuile est absente
+     */
+    QByteArray find(const TileKey& key);
+
+    /**
+     * @brief Vérifie si une tuile est présente sans modifier l'ordre LRU.
+     * @param key Identifiant de la tuile
+     * @return Vrai si les données de la tuile sont en cache
+     */
+    bool contains(const TileKey& key) const;
+
+    /**
+     * @brief Retire une tuile du cache.
+     * @param key Identifiant de la tuile
+     */
+    void remove(const TileKey& key);
+
+    /**
+     * @brief Vide le cache.
+     */
+    void clear();
+};
+
+#endif // TILEDATACACHE_H
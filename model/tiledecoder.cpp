@@ -0,0 +1,132 @@
+// tiledecoder.cpp
+#include "tiledecoder.h"
+
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+#include <utility>
+
+namespace {
+
+/**
+ * @class DecodeTask
+ * @brief Tâche de travail exécutant une fonction dans le groupe de threads.
+ */
+template <typename Function>
+class DecodeTask : public QRunnable {
+private:
+    Function _function; ///< Fonction à exécuter
+
+public:
+    explicit DecodeTask(Function function)
+        : _function(std::move(function))
+    {
+    }
+
+    void run() override { _function(); }
+};
+
+template <typename Function>
+QRunnable* makeTask(Function function)
+{
+    return new DecodeTask<Function>(std::move(function));
+}
+
+} // namespace
+
+TileDecoder::TileDecoder(QObject* parent)
+    : QObject(parent)
+    , _flushScheduled(false)
+    , _generation(0)
+{
+    // Laisser un cœur au thread graphique
+    _pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+}
+
+TileDecoder::~TileDecoder()
+{
+    _pool.clear();
+    _pool.waitForDone();
+}
+
+void TileDecoder::decode(const TileKey& key, const QByteArray& data, bool fromDisk, const TileFreshness& freshness)
+{
+    int generation;
+    {
+        QMutexLocker locker(&_resultsMutex);
+        generation = _generation;
+    }
+
+    _pending.insert(key);
+    _pool.start(makeTask([this, generation, key, data, fromDisk, freshness]() {
+        postResult(generation, { key, decodeImage(data), data, fromDisk, freshness });
+    }));
+}
+
+bool TileDecoder::isPending(const TileKey& key) const
+{
+    return _pending.contains(key);
+}
+
+bool TileDecoder::isIdle() const
+{
+    return _pending.isEmpty();
+}
+
+void TileDecoder::cancelAll()
+{
+    // Les tâches pas encore démarrées sont retirées, celles en cours seront ignorées
+    _pool.clear();
+    {
+        QMutexLocker locker(&_resultsMutex);
+        _generation++;
+        _results.clear();
+    }
+    _pending.clear();
+}
+
+void TileDecoder::postResult(int generation, DecodedTile tile)
+{
+    QMutexLocker locker(&_resultsMutex);
+    if (generation != _generation)
+        return;
+    _results.append(std::move(tile));
+
+    // Une seule livraison programmée à la fois : les résultats suivants rejoignent le lot
+    if (_flushScheduled)
+        return;
+    _flushScheduled = true;
+    QMetaObject::invokeMethod(this, [this]() { flushResults(); }, Qt::QueuedConnection);
+}
+
+void TileDecoder::flushResults()
+{
+    QVector<DecodedTile> batch;
+    {
+        QMutexLocker locker(&_resultsMutex);
+        batch.swap(_results);
+        _flushScheduled = false;
+    }
+
+    for (const DecodedTile& tile : qAsConst(batch))
+        _pending.remove(tile.key);
+
+    if (!batch.isEmpty())
+        emit tilesDecoded(batch);
+}
+
+QImage TileDecoder::decodeImage(const QByteArray& data)
+{
+    QImage image;
+    if (!image.loadFromData(data))
+        return QImage();
+
+    // PNG à palette (cas des tuiles OSM) ou en niveaux de gris : garder un octet par pixel,
+    // la conversion en ARGB32 ne se fait que pour les tuiles affichées
+    if (image.format() == QImage::Format_Indexed8 || image.format() == QImage::Format_Grayscale8)
+        return image;
+
+    // Format natif du moteur de rendu : la conversion en QPixmap n'a plus rien à faire
+    return image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+}
@@ -0,0 +1,115 @@
+// tiledecoder.h
+#ifndef TILEDECODER_H
+#define TILEDECODER_H
+
+#include "model/tilekey.h"
+#include "model/tilestore.h"
+#include <QByteArray>
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QThreadPool>
+#include <QVector>
+
+/**
+ * @struct DecodedTile
+ * @brief Résultat du décodage d'une tuile.
+ */
+struct DecodedTile {
+    TileKey key; ///< Identifiant de la tuile
+    QImage image; ///< Image décodée (Indexed8 pour un PNG à palette), nulle si le décodage a échoué
+    QByteArray data; ///< Données PNG d'origine
+    bool fromDisk; ///< Indique si les données proviennent du cache disque
+    TileFreshness freshness; ///< Fraîcheur HTTP des données téléchargées
+};
+
+/**
+ * @class TileDecoder
+ * @brief Décodage des tuiles PNG hors du thread graphique.
+ *
+ * Les tuiles sont décodées en QImage par un groupe de threads de
+ * travail. Les résultats sont accumulés puis livrés par lots dans le thread
+ * du décodeur. Les tuiles à palette restent en Format_Indexed8 : la
+ * conversion en QPixmap n'est faite par la vue que pour les tuiles affichées.
+ */
+class TileDecoder : public QObject {
+    Q_OBJECT
+
+private:
+    QThreadPool _pool; ///< Threads de décodage
+    QSet<TileKey> _pending; ///< Tuiles en cours de décodage (thread du décodeur)
+    QMutex _resultsMutex; ///< Protège la liste des résultats
+    QVector<DecodedTile> _results; ///< Résultats en attente de livraison
+    bool _flushScheduled; ///< Indique si une livraison est programmée (protégé par le mutex)
+    int _generation; ///< Numéro de la série de décodages en cours, incrémenté par cancelAll() (protégé par le mutex)
+
+public:
+    /**
+     * @brief Constructeur du décodeur de tuiles.
+     * @param parent Objet parent
+     */
+    explicit TileDecoder(QObject* parent = nullptr);
+
+    /**
+     * @brief Destructeur : attend la fin des décodages en cours.
+     */
+    ~TileDecoder();
+
+    /**
+     * @brief Décode en arrière-plan des données PNG.
+     * @param key Identifiant de la tuile
+     * @param data Données PNG de la tuile
+     * @param fromDisk Indique si les données proviennent du cache disque
+     * @param freshness Fraîcheur HTTP des données téléchargées, transmise avec le résultat
+     */
+    void decode(const TileKey& key, const QByteArray& data, bool fromDisk,
+        const TileFreshness& freshness = TileFreshness());
+
+    /**
+     * @brief Vérifie si une tuile est en cours de décodage.
+     * @param key Identifiant de la tuile
+     * @return Vrai si la tuile est en cours de décodage
+     */
+    bool isPending(const TileKey& key) const;
+
+    /**
+     * @brief Indique si aucun décodage n'est en cours.
+     * @return Vrai si le décodeur n'a plus de tuile à livrer
+     */
+    bool isIdle() const;
+
+    /**
+     * @brief Abandonne tous les décodages : ceux en cours ne seront pas livrés.
+     */
+    void cancelAll();
+
+signals:
+    /**
+     * @brief Signal émis avec un lot de tuiles décodées.
+     * @param tiles Tuiles décodées depuis la dernière livraison
+     */
+    void tilesDecoded(const QVector<DecodedTile>& tiles);
+
+private:
+    /**
+     * @brief Ajoute un résultat et programme sa livraison (appelé par les threads de travail).
+     * @param generation Série de décodages de la tâche
+     * @param tile Tuile décodée
+     */
+    void postResult(int generation, DecodedTile tile);
+
+    /**
+     * @brief Livre le lot de résultats accumulés.
+     */
+    void flushResults();
+
+    /**
+     * @brief Convertit des données PNG en image compacte (8 bits par pixel) ou prête à être dessinée.
+     * @param data Données PNG
+     * @return Image décodée, nulle en cas d'échec
+     */
+    static QImage decodeImage(const QByteArray& data);
+};
+
+#endif // TILEDECODER_H
@@ -0,0 +1,269 @@
+// tilediskcache.cpp
+#include "tilediskcache.h"
+
+#include <QDateTime>
+#include <QMetaObject>
+#include <QPair>
+#include <algorithm>
+
+namespace {
+
+const int kFlushDelay = 500; ///< Délai de regroupement des écritures, en millisecondes
+const int kMaxBatchSize = 256; ///< Taille de lot au-delà de laquelle l'écriture part sans attendre
+const double kEvictionTarget = 0.9; ///< Occupation visée après éviction, en fraction du quota
+const int kMinEvictionBatch = 64; ///< Nombre minimal de tuiles triées à chaque étape de l'éviction
+
+} // namespace
+
+TileDiskCache::TileDiskCache(TileStore* store, QObject* parent)
+    : QObject(parent)
+    , _store(store)
+    , _ioContext(new QObject)
+    , _indexReady(false)
+    , _maxBytes(512 * 1024 * 1024)
+    , _usedBytes(0)
+{
+    _ioContext->moveToThread(&_ioThread);
+    connect(&_ioThread, &QThread::finished, _ioContext, &QObject::deleteLater);
+    _ioThread.start();
+
+    _flushTimer.setSingleShot(true);
+    _flushTimer.setInterval(kFlushDelay);
+    connect(&_flushTimer, &QTimer::timeout, this, &TileDiskCache::flush);
+
+    // Ouvrir le stockage et recenser les tuiles présentes, hors du thread graphique
+    QMetaObject::invokeMethod(_ioContext, [this, store]() {
+        QHash<TileKey, TileRecord> index;
+        if (store->open())
+            index = store->index();
+
+        QMetaObject::invokeMethod(this, [this, index]() { onIndexLoaded(index); }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+}
+
+TileDiskCache::~TileDiskCache()
+{
+    flush();
+
+    // Les tâches déjà programmées (dont les écritures) sont exécutées avant la fermeture
+    TileStore* store = _store;
+    QMetaObject::invokeMethod(_ioContext, [store]() { delete store; }, Qt::QueuedConnection);
+    _ioThread.quit();
+    _ioThread.wait();
+}
+
+void TileDiskCache::setMaxBytes(qint64 maxBytes)
+{
+    _maxBytes = qMax<qint64>(0, maxBytes);
+    evict();
+}
+
+qint64 TileDiskCache::maxBytes() const
+{
+    return _maxBytes;
+}
+
+qint64 TileDiskCache::usedBytes() const
+{
+    return _usedBytes;
+}
+
+bool TileDiskCache::mayContain(const TileKey& key) const
+{
+    return !_indexReady || _index.contains(key);
+}
+
+void TileDiskCache::read(const TileKey& key)
+{
+    if (!mayContain(key)) {
+        emit tileMissing(key);
+        return;
+    }
+
+    _reading.insert(key);
+
+    // Mémoriser l'accès pour l'éviction LRU ; il est enregistré avec le prochain lot
+    auto record = _index.find(key);
+    if (record != _index.end()) {
+        record->lastAccess = QDateTime::currentSecsSinceEpoch();
+        _touched.insert(key);
+        scheduleFlush();
+    }
+
+    // Tuile pas encore écrite : la réponse reste asynchrone, comme une lecture sur le disque
+    auto pending = _pendingWrites.constFind(key);
+    if (pending != _pendingWrites.constEnd()) {
+        StoredTile tile = pending.value();
+        QMetaObject::invokeMethod(this, [this, tile]() { onReadFinished(tile, true); }, Qt::QueuedConnection);
+        return;
+    }
+
+    TileStore* store = _store;
+    QMetaObject::invokeMethod(_ioContext, [this, store, key]() {
+        StoredTile tile;
+        tile.key = key;
+        bool found = store->read(key, tile);
+        QMetaObject::invokeMethod(this, [this, tile, found]() { onReadFinished(tile, found); }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+}
+
+void TileDiskCache::write(const TileKey& key, const QByteArray& data, const TileFreshness& freshness)
+{
+    TileRecord& record = _index[key];
+    _usedBytes += data.size() - record.size;
+    record.size = data.size();
+    record.expires = freshness.expires;
+    record.lastAccess = QDateTime::currentSecsSinceEpoch();
+
+    _pendingWrites.insert(key, { key, data, freshness });
+    _touched.remove(key);
+
+    if (_pendingWrites.size() >= kMaxBatchSize)
+        flush();
+    else
+        scheduleFlush();
+
+    evict();
+}
+
+void TileDiskCache::refresh(const TileKey& key, const TileFreshness& freshness)
+{
+    auto record = _index.find(key);
+    if (record == _index.end())
+        return;
+    record->expires = freshness.expires;
+
+    // Tuile encore dans le lot d'écriture : mettre à jour sa fraîcheur sur place
+    auto pending = _pendingWrites.find(key);
+    if (pending != _pendingWrites.end()) {
+        if (!freshness.etag.isEmpty())
+            pending->freshness.etag = freshness.etag;
+        if (!freshness.lastModified.isEmpty())
+            pending->freshness.lastModified = freshness.lastModified;
+        pending->freshness.expires = freshness.expires;
+        return;
+    }
+
+    _pendingRefresh.append({ key, QByteArray(), freshness });
+    scheduleFlush();
+}
+
+void TileDiskCache::flush()
+{
+    _flushTimer.stop();
+    if (_pendingWrites.isEmpty() && _pendingRefresh.isEmpty() && _touched.isEmpty())
+        return;
+
+    QVector<StoredTile> batch;
+    batch.reserve(_pendingWrites.size());
+    for (auto it = _pendingWrites.constBegin(); it != _pendingWrites.constEnd(); ++it)
+        batch.append(it.value());
+    _pendingWrites.clear();
+
+    QVector<StoredTile> refreshed;
+    refreshed.swap(_pendingRefresh);
+
+    QVector<TileKey> touched(_touched.constBegin(), _touched.constEnd());
+    _touched.clear();
+
+    // Les lectures programmées ensuite passent après ce lot dans le thread d'E/S
+    TileStore* store = _store;
+    qint64 now = QDateTime::currentSecsSinceEpoch();
+    QMetaObject::invokeMethod(_ioContext, [store, batch, refreshed, touched, now]() {
+        store->write(batch, now);
+        store->updateFreshness(refreshed);
+        store->touch(touched, now);
+    }, Qt::QueuedConnection);
+}
+
+bool TileDiskCache::isPending(const TileKey& key) const
+{
+    return _reading.contains(key);
+}
+
+bool TileDiskCache::isIdle() const
+{
+    return _reading.isEmpty();
+}
+
+void TileDiskCache::scheduleFlush()
+{
+    if (!_flushTimer.isActive())
+        _flushTimer.start();
+}
+
+void TileDiskCache::evict()
+{
+    if (_usedBytes <= _maxBytes)
+        return;
+
+    // Candidates par dernier accès ; les tuiles en cours de lecture sont épargnées
+    QVector<QPair<qint64, TileKey>> candidates;
+    candidates.reserve(_index.size());
+    for (auto it = _index.constBegin(); it != _index.constEnd(); ++it) {
+        if (!_reading.contains(it.key()))
+            candidates.append(qMakePair(it->lastAccess, it.key()));
+    }
+    auto byAccess = [](const QPair<qint64, TileKey>& a, const QPair<qint64, TileKey>& b) { return a.first < b.first; };
+
+    // Descendre sous le quota avec une marge, pour ne pas évincer à chaque écriture
+    qint64 target = static_cast<qint64>(_maxBytes * kEvictionTarget);
+    qint64 averageSize = qMax<qint64>(1, _usedBytes / qMax(1, _index.size()));
+    QVector<TileKey> evicted;
+
+    // Sélection partielle : seules les plus anciennes tuiles, à peu près assez pour atteindre
+    // la cible d'après la taille moyenne, sont triées ; l'étape suivante reprend au besoin
+    auto begin = candidates.begin();
+    while (_usedBytes > target && begin != candidates.end()) {
+        qint64 wanted = (_usedBytes - target) / averageSize * 5 / 4 + kMinEvictionBatch;
+        auto middle = begin + qMin<qint64>(wanted, candidates.end() - begin);
+        std::nth_element(begin, middle, candidates.end(), byAccess);
+        std::sort(begin, middle, byAccess);
+
+        for (auto it = begin; it != middle && _usedBytes > target; ++it) {
+            const TileKey& key = it->second;
+            _usedBytes -= _index.take(key).size;
+            _pendingWrites.remove(key);
+            _touched.remove(key);
+            evicted.append(key);
+        }
+        begin = middle;
+    }
+
+    TileStore* store = _store;
+    QMetaObject::invokeMethod(_ioContext, [store, evicted]() { store->remove(evicted); }, Qt::QueuedConnection);
+}
+
+void TileDiskCache::onReadFinished(const StoredTile& tile, bool found)
+{
+    _reading.remove(tile.key);
+
+    if (!found) {
+        auto record = _index.find(tile.key);
+        if (record != _index.end()) {
+            _usedBytes -= record->size;
+            _index.erase(record);
+        }
+        emit tileMissing(tile.key);
+        return;
+    }
+
+    // Une tuile périmée est servie tout de suite, puis revalidée en arrière-plan
+    emit tileRead(tile.key, tile.data);
+    if (tile.freshness.expires <= QDateTime::currentSecsSinceEpoch())
+        emit tileExpired(tile.key, tile.freshness);
+}
+
+void TileDiskCache::onIndexLoaded(const QHash<TileKey, TileRecord>& index)
+{
+    // Les tuiles écrites entre-temps sont déjà dans l'index, avec des informations plus récentes
+    for (auto it = index.constBegin(); it != index.constEnd(); ++it) {
+        if (_index.contains(it.key()))
+            continue;
+        _index.insert(it.key(), it.value());
+        _usedBytes += it->size;
+    }
+    _indexReady = true;
+
+    evict();
+}
@@ -0,0 +1,184 @@
+// tilediskcache.h
+#ifndef TILEDISKCACHE_H
+#define TILEDISKCACHE_H
+
+#include "model/tilekey.h"
+#include "model/tilestore.h"
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QThread>
+#include <QTimer>
+#include <QVector>
+
+/**
+ * @class TileDiskCache
+ * @brief Cache disque des tuiles PNG, accédé depuis un thread d'entrées/sorties.
+ *
+ * Les lectures, écritures et le recensement initial du stockage s'exécutent
+ * dans un thread dédié. Un index en mémoire des tuiles présentes permet de
+ * répondre aux recherches sans appel système.
+ *
+ * Le format sur le disque est délégué à un TileStore (un fichier par tuile ou
+ * fichier unique MBTiles). Les écritures sont regroupées en lots, envoyés au
+ * stockage après un court délai ; une tuile d'un lot pas encore envoyé est
+ * lue directement depuis la mémoire.
+ *
+ * L'occupation est bornée par un quota : au-delà, les tuiles les moins
+ * récemment lues sont supprimées. Une tuile périmée est tout de même servie,
+ * et signalée par tileExpired() pour être revalidée en arrière-plan.
+ */
+class TileDiskCache : public QObject {
+    Q_OBJECT
+
+private:
+    TileStore* _store; ///< Stockage des tuiles, utilisé uniquement dans le thread d'E/S
+    QThread _ioThread; ///< Thread d'entrées/sorties
+    QObject* _ioContext; ///< Objet vivant dans le thread d'E/S, cible des tâches
+    QHash<TileKey, TileRecord> _index; ///< Tuiles présentes sur le disque, avec taille, validité et dernier accès
+    QSet<TileKey> _reading; ///< Tuiles en cours de lecture
+    bool _indexReady; ///< Indique si le parcours initial du répertoire est terminé
+    QHash<TileKey, StoredTile> _pendingWrites; ///< Tuiles du prochain lot d'écriture
+    QVector<StoredTile> _pendingRefresh; ///< Tuiles revalidées dont la fraîcheur reste à enregistrer
+    QSet<TileKey> _touched; ///< Tuiles lues dont le dernier accès reste à enregistrer
+    QTimer _flushTimer; ///< Délai de regroupement des écritures
+    qint64 _maxBytes; ///< Quota d'occupation du disque, en octets
+    qint64 _usedBytes; ///< Occupation des tuiles indexées, en octets
+
+public:
+    /**
+     * @brief Constructeur du cache disque.
+     *
+     * Ouvre le stockage et recense les tuiles présentes en arrière-plan.
+     * @param store Stockage des tuiles (le cache en prend possession)
+     * @param parent Objet parent
+     */
+    explicit TileDiskCache(TileStore* store, QObject* parent = nullptr);
+
+    /**
+     * @brief Destructeur : termine les écritures en attente et ferme le stockage.
+     */
+    ~TileDiskCache();
+
+    /**
+     * @brief Définit le quota d'occupation du disque.
+     *
+     * Les tuiles les moins récemment lues sont supprimées si l'occupation
+     * dépasse le nouveau quota.
+     * @param maxBytes Quota en octets
+     */
+    void setMaxBytes(qint64 maxBytes);
+
+    /**
+     * @brief Récupère le quota d'occupation du disque.
+     * @return Quota en octets
+     */
+    qint64 maxBytes() const;
+
+    /**
+     * @brief Récupère l'occupation des tuiles connues.
+     * @return Occupation en octets
+     */
+    qint64 usedBytes() const;
+
+    /**
+     * @brief Vérifie, sans appel système, si une tuile peut être présente sur le disque.
+     *
+     * Tant que le parcours initial n'est pas terminé, toute tuile est considérée
+     * comme possiblement présente.
+     * @param key Identifiant de la tuile
+     * @return Faux si la tuile est absente à coup sûr
+     */
+    bool mayContain(const TileKey& key) const;
+
+    /**
+     * @brief Lit une tuile en arrière-plan.
+     *
+     * Le résultat est signalé par tileRead() ou tileMissing(), suivi de
+     * tileExpired() si la tuile lue est périmée.
+     * @param key Identifiant de la tuile
+     */
+    void read(const TileKey& key);
+
+    /**
+     * @brief Écrit une tuile en arrière-plan, avec le prochain lot.
+     * @param key Identifiant de la tuile
+     * @param data Données PNG de la tuile
+     * @param freshness Validateurs et fin de validité de la réponse
+     */
+    void write(const TileKey& key, const QByteArray& data, const TileFreshness& freshness);
+
+    /**
+     * @brief Prolonge la validité d'une tuile confirmée par le serveur (réponse 304).
+     * @param key Identifiant de la tuile
+     * @param freshness Nouvelle fraîcheur (un validateur vide conserve l'ancien)
+     */
+    void refresh(const TileKey& key, const TileFreshness& freshness);
+
+    /**
+     * @brief Envoie immédiatement au stockage le lot d'écritures en attente.
+     */
+    void flush();
+
+    /**
+     * @brief Vérifie si une tuile est en cours de lecture.
+     * @param key Identifiant de la tuile
+     * @return Vrai si la tuile est en cours de lecture
+     */
+    bool isPending(const TileKey& key) const;
+
+    /**
+     * @brief Indique si aucune lecture n'est en cours.
+     * @return Vrai si le cache n'attend aucune lecture
+     */
+    bool isIdle() const;
+
+signals:
+    /**
+     * @brief Signal émis lorsqu'une tuile a été lue depuis le disque.
+     * @param key Identifiant de la tuile
+     * @param data Données PNG de la tuile
+     */
+    void tileRead(const TileKey& key, const QByteArray& data);
+
+    /**
+     * @brief Signal émis lorsqu'une tuile demandée est absente du disque.
+     * @param key Identifiant de la tuile
+     */
+    void tileMissing(const TileKey& key);
+
+    /**
+     * @brief Signal émis après tileRead() lorsque la tuile lue est périmée.
+     * @param key Identifiant de la tuile
+     * @param freshness Validateurs à utiliser pour la requête conditionnelle
+     */
+    void tileExpired(const TileKey& key, const TileFreshness& freshness);
+
+private:
+    /**
+     * @brief Programme l'envoi du lot d'écritures après le délai de regroupement.
+     */
+    void scheduleFlush();
+
+    /**
+     * @brief Supprime les tuiles les moins récemment lues tant que le quota est dépassé.
+     */
+    void evict();
+
+    /**
+     * @brief Traite le résultat d'une lecture dans le thread du cache.
+     * @param tile Tuile lue (seul l'identifiant est valide si elle est absente)
+     * @param found Indique si la tuile a été trouvée
+     */
+    void onReadFinished(const StoredTile& tile, bool found);
+
+    /**
+     * @brief Intègre l'index construit par le parcours du stockage.
+     * @param index Tuiles trouvées sur le disque
+     */
+    void onIndexLoaded(const QHash<TileKey, TileRecord>& index);
+};
+
+#endif // TILEDISKCACHE_H
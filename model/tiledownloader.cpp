@@ -0,0 +1,540 @@
+// tiledownloader.cpp
+#include "tiledownloader.h"
+
+#include <QDateTime>
+#include <QLocale>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QTimer>
+#include <QUrl>
+#include <QRandomGenerator>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+namespace {
+
+const qint64 kRetryBaseDelay = 2000; ///< Délai avant la première relance, en millisecondes
+const qint64 kRetryMaxDelay = 5 * 60 * 1000; ///< Délai maximal entre deux relances, en millisecondes
+const qint64 kNotFoundDelay = 60 * 60 * 1000; ///< Délai avant de redemander une tuile absente (404), en millisecondes
+const int kMaxRetryQueue = 64; ///< Nombre maximal de tuiles relancées automatiquement
+const int kBreakerThreshold = 5; ///< Échecs consécutifs d'un hôte avant l'ouverture du disjoncteur
+const qint64 kBreakerBaseCooldown = 10 * 1000; ///< Première pause du disjoncteur, en millisecondes
+
+/**
+ * @brief Lit l'en-tête Retry-After (secondes ou date HTTP).
+ * @return Délai en millisecondes, ou -1 si l'en-tête est absent ou illisible
+ */
+qint64 retryAfterOf(QNetworkReply* reply)
+{
+    QByteArray value = reply->rawHeader("Retry-After").trimmed();
+    if (value.isEmpty())
+        return -1;
+
+    bool ok = false;
+    qint64 seconds = value.toLongLong(&ok);
+    if (ok)
+        return qMax<qint64>(0, seconds) * 1000;
+
+    QDateTime date = QLocale::c().toDateTime(QString::fromLatin1(value), "ddd, dd MMM yyyy HH:mm:ss 'GMT'");
+    if (!date.isValid())
+        return -1;
+    date.setTimeSpec(Qt::UTC);
+    return qMax<qint64>(0, QDateTime::currentDateTimeUtc().msecsTo(date));
+}
+
+} // namespace
+
+TileDownloader::TileDownloader(QObject* parent)
+    : QObject(parent)
+    , _queueSorted(true)
+    , _dispatchScheduled(false)
+    , _source(TileSource::openStreetMap())
+    , _maxConcurrent(_source.maxConcurrent())
+    , _hostCount(1)
+    , _focusZoom(-1)
+{
+    _clock.start();
+
+    _retryTimer.setSingleShot(true);
+    connect(&_retryTimer, &QTimer::timeout, this, &TileDownloader::onRetryTimer);
+
+    setSource(_source);
+}
+
+TileDownloader::~TileDownloader()
+{
+    cancelAll();
+}
+
+void TileDownloader::request(const TileKey& key)
+{
+    // Fusionner avec une requête déjà en attente ou en cours pour la même tuile
+    if (_inFlight.contains(key) || _queued.contains(key))
+        return;
+
+    // Tuile en échec : pas de nouvel aller-retour avant la fin de son délai
+    if (isBackingOff(key))
+        return;
+
+    // Une tuile en attente de préchargement devient prioritaire
+    if (_prefetchQueued.remove(key))
+        _prefetchQueue.removeOne(key);
+
+    // Une revalidation pas encore lancée devient un téléchargement complet
+    if (_revalidateQueue.removeOne(key))
+        _validators.remove(key);
+
+    _queue.append(key);
+    _queued.insert(key);
+    _queueSorted = false;
+    scheduleDispatch();
+}
+
+void TileDownloader::prefetch(const TileKey& key)
+{
+    if (isPending(key) || isBackingOff(key))
+        return;
+
+    _prefetchQueue.append(key);
+    _prefetchQueued.insert(key);
+    scheduleDispatch();
+}
+
+void TileDownloader::clearPrefetch()
+{
+    _prefetchQueue.clear();
+    _prefetchQueued.clear();
+}
+
+void TileDownloader::revalidate(const TileKey& key, const TileFreshness& freshness)
+{
+    if (isPending(key))
+        return;
+
+    _validators.insert(key, freshness);
+    _revalidateQueue.append(key);
+    scheduleDispatch();
+}
+
+void TileDownloader::setViewport(int zoom, const QPointF& center, const QRectF& visible)
+{
+    _focusZoom = zoom;
+    _focusCenter = center;
+    _focusVisible = visible;
+
+    // Réordonner la file d'attente selon la nouvelle vue
+    _queueSorted = false;
+    scheduleDispatch();
+}
+
+void TileDownloader::setSource(const TileSource& source)
+{
+    // Les requêtes et les échecs mémorisés concernaient l'ancien serveur
+    cancelAll();
+    _failures.clear();
+    _hosts.clear();
+
+    _source = source;
+    _maxConcurrent = source.maxConcurrent();
+
+    // Ouvrir dès maintenant une connexion par hôte (résolution DNS et négociation TLS comprises),
+    // réutilisée ensuite par toutes les requêtes
+    const QStringList hosts = source.hosts();
+    _hostCount = qMax(1, hosts.size());
+    bool encrypted = source.url({ 0, 0, 0 }).scheme() == "https";
+    for (const QString& host : hosts) {
+        if (encrypted)
+            _networkManager.connectToHostEncrypted(host);
+        else
+            _networkManager.connectToHost(host);
+    }
+}
+
+const TileSource& TileDownloader::source() const
+{
+    return _source;
+}
+
+void TileDownloader::setMaxConcurrent(int maxConcurrent)
+{
+    _maxConcurrent = qMax(1, maxConcurrent);
+    scheduleDispatch();
+}
+
+void TileDownloader::cancelOutside(int zoom, const QRect& range)
+{
+    QHash<int, QRect> ranges;
+    ranges.insert(zoom, range);
+    cancelOutside(ranges);
+}
+
+void TileDownloader::cancelOutside(const QHash<int, QRect>& ranges)
+{
+    // Les préchargements, hors zone par nature, ne sont pas concernés
+    auto isStale = [this, &ranges](const TileKey& key) {
+        auto range = ranges.constFind(key.zoom);
+        return !_prefetchInFlight.contains(key) && (range == ranges.constEnd() || !range->contains(key.x, key.y));
+    };
+
+    // Les tuiles en attente sont simplement retirées de la file
+    auto end = std::remove_if(_queue.begin(), _queue.end(), [this, &isStale](const TileKey& key) {
+        if (!isStale(key))
+            return false;
+        _queued.remove(key);
+        return true;
+    });
+    _queue.erase(end, _queue.end());
+
+    // Retirer d'abord les requêtes de la table : abort() émet finished() immédiatement
+    QList<QNetworkReply*> stale;
+    for (auto it = _inFlight.begin(); it != _inFlight.end();) {
+        if (isStale(it.key())) {
+            stale.append(it.value());
+            it = _inFlight.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (QNetworkReply* reply : stale)
+        reply->abort();
+
+    // Des places se sont libérées pour les tuiles encore utiles
+    if (!stale.isEmpty())
+        scheduleDispatch();
+}
+
+void TileDownloader::cancelAll()
+{
+    _queue.clear();
+    _queued.clear();
+    clearPrefetch();
+    _prefetchInFlight.clear();
+    _revalidateQueue.clear();
+    _validators.clear();
+    _retryQueue.clear();
+    _retryTimer.stop();
+
+    QList<QNetworkReply*> stale = _inFlight.values();
+    _inFlight.clear();
+
+    for (QNetworkReply* reply : stale)
+        reply->abort();
+}
+
+bool TileDownloader::isBackingOff(const TileKey& key) const
+{
+    auto failure = _failures.constFind(key);
+    return failure != _failures.constEnd() && _clock.elapsed() < failure->retryAt;
+}
+
+bool TileDownloader::isPending(const TileKey& key) const
+{
+    return _inFlight.contains(key) || _queued.contains(key) || _prefetchQueued.contains(key)
+        || _validators.contains(key);
+}
+
+int TileDownloader::pendingCount() const
+{
+    return _inFlight.size() + _queue.size() + _prefetchQueue.size() + _revalidateQueue.size();
+}
+
+void TileDownloader::scheduleDispatch()
+{
+    if (_dispatchScheduled)
+        return;
+
+    _dispatchScheduled = true;
+    QTimer::singleShot(0, this, &TileDownloader::dispatch);
+}
+
+void TileDownloader::dispatch()
+{
+    _dispatchScheduled = false;
+
+    if (!_queueSorted) {
+        // Trier par priorité décroissante : la tuile la plus urgente est retirée en fin de file
+        QVector<QPair<double, TileKey>> ranked;
+        ranked.reserve(_queue.size());
+        for (const TileKey& key : qAsConst(_queue))
+            ranked.append(qMakePair(priorityOf(key), key));
+
+        std::sort(ranked.begin(), ranked.end(),
+            [](const QPair<double, TileKey>& a, const QPair<double, TileKey>& b) {
+                return a.first > b.first;
+            });
+
+        for (int i = 0; i < ranked.size(); i++)
+            _queue[i] = ranked[i].second;
+        _queueSorted = true;
+    }
+
+    // Les tuiles d'un hôte dont le disjoncteur est ouvert restent en file jusqu'à la fin de la pause
+    while (_inFlight.size() < _maxConcurrent && !_queue.isEmpty()) {
+        int index = nextStartable(_queue, true);
+        if (index < 0)
+            return;
+        TileKey key = _queue.takeAt(index);
+        _queued.remove(key);
+        startRequest(key);
+    }
+
+    // Revalidation et préchargement seulement quand plus aucune tuile demandée
+    // n'attend, en gardant la moitié des places libres pour les tuiles visibles
+    int maxPrefetch = qMax(1, _maxConcurrent / 2);
+    while (_queue.isEmpty() && !_revalidateQueue.isEmpty()
+        && _inFlight.size() < _maxConcurrent && _prefetchInFlight.size() < maxPrefetch) {
+        int index = nextStartable(_revalidateQueue, false);
+        if (index < 0)
+            return;
+        TileKey key = _revalidateQueue.takeAt(index);
+        _prefetchInFlight.insert(key);
+        startRequest(key);
+    }
+
+    while (_queue.isEmpty() && !_prefetchQueue.isEmpty()
+        && _inFlight.size() < _maxConcurrent && _prefetchInFlight.size() < maxPrefetch) {
+        int index = nextStartable(_prefetchQueue, false);
+        if (index < 0)
+            return;
+        TileKey key = _prefetchQueue.takeAt(index);
+        _prefetchQueued.remove(key);
+        _prefetchInFlight.insert(key);
+        startRequest(key);
+    }
+}
+
+int TileDownloader::nextStartable(const QVector<TileKey>& queue, bool mostUrgentLast)
+{
+    QSet<QString> blocked;
+    for (int i = 0; i < queue.size() && blocked.size() < _hostCount; i++) {
+        int index = mostUrgentLast ? queue.size() - 1 - i : i;
+        QString host = tileUrl(queue.at(index)).host();
+        if (blocked.contains(host))
+            continue;
+        if (acquireHost(host))
+            return index;
+        blocked.insert(host);
+    }
+    return -1;
+}
+
+QUrl TileDownloader::tileUrl(const TileKey& key) const
+{
+    return _source.url(key);
+}
+
+bool TileDownloader::acquireHost(const QString& host)
+{
+    auto state = _hosts.find(host);
+    if (state == _hosts.end() || state->failures < kBreakerThreshold)
+        return true;
+
+    // Disjoncteur ouvert : attendre la fin de la pause (un lancement est programmé à cette échéance)
+    if (_clock.elapsed() < state->openUntil || state->probing)
+        return false;
+
+    // Fin de la pause : une seule requête d'essai décide de la fermeture
+    state->probing = true;
+    return true;
+}
+
+void TileDownloader::recordFailure(const TileKey& key, QNetworkReply* reply)
+{
+    int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    Failure& failure = _failures[key];
+    failure.attempts++;
+
+    // Tuile absente du serveur : cache négatif, sans relance automatique
+    if (status == 404 || status == 410) {
+        failure.retryAt = _clock.elapsed() + kNotFoundDelay;
+        return;
+    }
+
+    // Délai doublé à chaque échec, avec une part aléatoire pour étaler les relances
+    qint64 delay = retryAfterOf(reply);
+    if (delay < 0) {
+        delay = qMin(kRetryMaxDelay, kRetryBaseDelay << qMin(failure.attempts - 1, 16));
+        delay += QRandomGenerator::global()->bounded(static_cast<int>(delay / 4) + 1);
+    }
+    failure.retryAt = _clock.elapsed() + delay;
+
+    // File de relance bornée : au-delà, la tuile attendra d'être redemandée par la vue
+    if (!_retryQueue.contains(key) && _retryQueue.size() < kMaxRetryQueue) {
+        _retryQueue.append(key);
+        scheduleRetry();
+    }
+}
+
+void TileDownloader::recordHostResult(const QString& host, bool success)
+{
+    HostState& state = _hosts[host];
+    if (success) {
+        state = HostState();
+        return;
+    }
+
+    state.probing = false;
+    state.failures++;
+    if (state.failures < kBreakerThreshold)
+        return;
+
+    // Ouvrir le disjoncteur, plus longtemps à chaque essai manqué
+    state.cooldown = state.cooldown == 0 ? kBreakerBaseCooldown : qMin(kRetryMaxDelay, state.cooldown * 2);
+    state.openUntil = _clock.elapsed() + state.cooldown;
+    QTimer::singleShot(static_cast<int>(state.cooldown), this, &TileDownloader::scheduleDispatch);
+}
+
+void TileDownloader::scheduleRetry()
+{
+    if (_retryQueue.isEmpty()) {
+        _retryTimer.stop();
+        return;
+    }
+
+    qint64 next = -1;
+    for (const TileKey& key : qAsConst(_retryQueue)) {
+        qint64 retryAt = _failures.value(key).retryAt;
+        next = next < 0 ? retryAt : qMin(next, retryAt);
+    }
+    _retryTimer.start(static_cast<int>(qBound<qint64>(0, next - _clock.elapsed(), INT_MAX)));
+}
+
+void TileDownloader::onRetryTimer()
+{
+    qint64 now = _clock.elapsed();
+
+    // Seules les tuiles proches de la vue sont relancées ; les autres le seront à la demande
+    QRectF area = _focusVisible.adjusted(-1, -1, 1, 1);
+    QVector<TileKey> waiting;
+    for (const TileKey& key : qAsConst(_retryQueue)) {
+        if (_failures.value(key).retryAt > now) {
+            waiting.append(key);
+            continue;
+        }
+        if (key.zoom == _focusZoom && area.intersects(QRectF(key.x, key.y, 1.0, 1.0)))
+            request(key);
+    }
+    _retryQueue = waiting;
+    scheduleRetry();
+}
+
+void TileDownloader::startRequest(const TileKey& key)
+{
+    // Créer la requête (User-Agent, en-têtes et HTTP/2 selon la source)
+    QNetworkRequest request = _source.request(key);
+
+    // Revalidation : le serveur ne renvoie les données que si la tuile a changé
+    auto validators = _validators.constFind(key);
+    if (validators != _validators.constEnd()) {
+        if (!validators->etag.isEmpty())
+            request.setRawHeader("If-None-Match", validators->etag);
+        if (!validators->lastModified.isEmpty())
+            request.setRawHeader("If-Modified-Since", validators->lastModified);
+    }
+
+    // Envoyer la requête ; la tuile reste associée à la réponse via la connexion
+    QNetworkReply* reply = _networkManager.get(request);
+    _inFlight.insert(key, reply);
+
+    connect(reply, &QNetworkReply::finished, this,
+        [this, key, reply]() { this->onReplyFinished(key, reply); });
+}
+
+double TileDownloader::priorityOf(const TileKey& key) const
+{
+    // Les tuiles d'un autre niveau de zoom passent après toutes les autres
+    if (key.zoom != _focusZoom)
+        return 2e9;
+
+    // Distance entre le centre de la tuile et le centre de la vue
+    double dx = key.x + 0.5 - _focusCenter.x();
+    double dy = key.y + 0.5 - _focusCenter.y();
+    double distance = std::sqrt(dx * dx + dy * dy);
+
+    // Les tuiles visibles passent avant les marges de préchargement
+    bool visible = _focusVisible.intersects(QRectF(key.x, key.y, 1.0, 1.0));
+    return visible ? distance : 1e9 + distance;
+}
+
+TileFreshness TileDownloader::freshnessOf(QNetworkReply* reply)
+{
+    TileFreshness freshness;
+    freshness.etag = reply->rawHeader("ETag");
+    freshness.lastModified = reply->rawHeader("Last-Modified");
+
+    qint64 now = QDateTime::currentSecsSinceEpoch();
+    qint64 maxAge = -1;
+
+    // Cache-Control prime sur Expires ; no-cache impose une revalidation à chaque lecture
+    const QList<QByteArray> directives = reply->rawHeader("Cache-Control").split(',');
+    for (const QByteArray& directive : directives) {
+        QByteArray value = directive.trimmed().toLower();
+        if (value.startsWith("max-age=")) {
+            bool ok = false;
+            qint64 seconds = value.mid(8).toLongLong(&ok);
+            if (ok)
+                maxAge = qMax<qint64>(0, seconds);
+        } else if (value == "no-cache" || value == "no-store") {
+            maxAge = 0;
+            break;
+        }
+    }
+
+    if (maxAge < 0 && reply->hasRawHeader("Expires")) {
+        // Format des dates HTTP : Sun, 06 Nov 1994 08:49:37 GMT
+        QString expires = QString::fromLatin1(reply->rawHeader("Expires")).trimmed();
+        QDateTime date = QLocale::c().toDateTime(expires, "ddd, dd MMM yyyy HH:mm:ss 'GMT'");
+        if (date.isValid()) {
+            date.setTimeSpec(Qt::UTC);
+            maxAge = qMax<qint64>(0, date.toSecsSinceEpoch() - now);
+        }
+    }
+
+    freshness.expires = now + (maxAge < 0 ? TileFreshness::kDefaultMaxAge : maxAge);
+    return freshness;
+}
+
+void TileDownloader::onReplyFinished(const TileKey& key, QNetworkReply* reply)
+{
+    // Une requête annulée a déjà été retirée de la table
+    bool cancelled = _inFlight.value(key) != reply;
+    if (!cancelled) {
+        _inFlight.remove(key);
+        _prefetchInFlight.remove(key);
+        _validators.remove(key);
+    }
+
+    // Une place s'est libérée : lancer la suivante
+    scheduleDispatch();
+
+    QString host = reply->request().url().host();
+    if (cancelled || reply->error() == QNetworkReply::OperationCanceledError) {
+        // Une requête d'essai annulée ne doit pas bloquer le disjoncteur (sans créer d'état pour l'hôte)
+        auto it = _hosts.find(host);
+        if (it != _hosts.end())
+            it->probing = false;
+        reply->deleteLater();
+        return;
+    }
+
+    // Le disjoncteur ne compte que les pannes du serveur ou du réseau, pas les tuiles absentes
+    int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    bool serverFailure = reply->error() != QNetworkReply::NoError && status != 404 && status != 410;
+    recordHostResult(host, !serverFailure);
+
+    if (reply->error() != QNetworkReply::NoError) {
+        recordFailure(key, reply);
+        emit tileFailed(key, reply->errorString());
+    } else {
+        _failures.remove(key);
+        if (status == 304)
+            emit tileNotModified(key, freshnessOf(reply));
+        else
+            emit tileDownloaded(key, reply->readAll(), freshnessOf(reply));
+    }
+
+    // Libérer la mémoire
+    reply->deleteLater();
+}
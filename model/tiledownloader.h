@@ -0,0 +1,329 @@
+// tiledownloader.h
+#ifndef TILEDOWNLOADER_H
+#define TILEDOWNLOADER_H
+
+#include "model/tilekey.h"
+#include "model/tilesource.h"
+#include "model/tilestore.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QNetworkAccessManager>
+#include <QObject>
+#include <QPointF>
+#include <QRect>
+#include <QRectF>
+#include <QSet>
+#include <QTimer>
+#include <QUrl>
+#include <QVector>
+
+class QNetworkReply;
+
+/**
+ * @class TileDownloader
+ * @brief Téléchargement des tuiles depuis un serveur de tuiles.
+ *
+ * Le serveur est décrit par une TileSource (OpenStreetMap par défaut), qui
+ * fournit les URL, les en-têtes et la limite de requêtes simultanées.
+ *
+ * Cette classe tient une table des requêtes en cours indexée par tuile :
+ * une tuile déjà en cours de téléchargement n'est jamais redemandée, et les
+ * requêtes devenues inutiles (changement de zoom, long déplacement) peuvent
+ * être annulées.
+ *
+ * Les demandes passent par une file d'attente ordonnée par distance au centre
+ * de la vue, les tuiles visibles passant avant les marges de préchargement,
+ * et le nombre de requêtes simultanées est plafonné.
+ *
+ * Les tuiles de préchargement forment une seconde file, servie seulement
+ * lorsque aucune tuile demandée n'attend et avec au plus la moitié des
+ * requêtes simultanées.
+ *
+ * Les revalidations de tuiles périmées passent par une troisième file,
+ * servie avant le préchargement et dans la même limite. Leurs requêtes sont
+ * conditionnelles (If-None-Match, If-Modified-Since) : une tuile inchangée
+ * ne coûte qu'une réponse « 304 Not Modified », sans données.
+ *
+ * Les échecs sont mémorisés par tuile : une tuile en échec n'est plus
+ * demandée avant un délai qui double à chaque tentative (ou celui de
+ * Retry-After), et une tuile absente du serveur (404) n'est pas redemandée
+ * avant une heure. Une file de relance bornée redemande d'elle-même les
+ * tuiles encore visibles. Par hôte, un disjoncteur suspend toutes les
+ * requêtes après plusieurs échecs consécutifs, puis laisse passer une seule
+ * requête d'essai à la fin de la pause.
+ */
+class TileDownloader : public QObject {
+    Q_OBJECT
+
+private:
+    QNetworkAccessManager _networkManager; ///< Gestionnaire de réseau pour télécharger les tuiles
+    QHash<TileKey, QNetworkReply*> _inFlight; ///< Requêtes en cours, indexées par tuile
+    QVector<TileKey> _queue; ///< Tuiles en attente, la plus prioritaire en dernier une fois triée
+    QSet<TileKey> _queued; ///< Tuiles présentes dans la file d'attente
+    bool _queueSorted; ///< Indique si la file d'attente est triée par priorité
+    bool _dispatchScheduled; ///< Indique si un lancement de requêtes est déjà programmé
+    TileSource _source; ///< Serveur de tuiles
+    int _maxConcurrent; ///< Nombre maximal de requêtes simultanées
+    int _hostCount; ///< Nombre d'hôtes distincts de la source
+    int _focusZoom; ///< Niveau de zoom de la vue courante
+    QPointF _focusCenter; ///< Centre de la vue en coordonnées de tuile
+    QRectF _focusVisible; ///< Zone visible de la vue en coordonnées de tuile
+    QVector<TileKey> _prefetchQueue; ///< Tuiles à précharger, la plus utile en premier
+    QSet<TileKey> _prefetchQueued; ///< Tuiles présentes dans la file de préchargement
+    QSet<TileKey> _prefetchInFlight; ///< Requêtes de préchargement ou de revalidation en cours
+    QVector<TileKey> _revalidateQueue; ///< Tuiles périmées à revalider, la plus ancienne demande en premier
+    QHash<TileKey, TileFreshness> _validators; ///< Validateurs des revalidations en attente ou en cours
+
+    /**
+     * @struct Failure
+     * @brief Échec mémorisé pour une tuile.
+     */
+    struct Failure {
+        int attempts = 0; ///< Nombre d'échecs consécutifs
+        qint64 retryAt = 0; ///< Instant avant lequel la tuile n'est pas redemandée (horloge interne, ms)
+    };
+
+    /**
+     * @struct HostState
+     * @brief État du disjoncteur d'un hôte.
+     */
+    struct HostState {
+        int failures = 0; ///< Nombre d'échecs consécutifs
+        qint64 openUntil = 0; ///< Fin de la pause des requêtes (horloge interne, ms)
+        qint64 cooldown = 0; ///< Durée de la dernière pause, en millisecondes
+        bool probing = false; ///< Indique si la requête d'essai est en cours
+    };
+
+    QElapsedTimer _clock; ///< Horloge monotone des délais de relance
+    QHash<TileKey, Failure> _failures; ///< Tuiles en échec et date de relance possible
+    QVector<TileKey> _retryQueue; ///< Tuiles à relancer automatiquement, bornée
+    QTimer _retryTimer; ///< Déclenchement de la prochaine relance
+    QHash<QString, HostState> _hosts; ///< Disjoncteurs, par hôte
+
+public:
+    /**
+     * @brief Constructeur du téléchargeur de tuiles.
+     * @param parent Objet parent
+     */
+    explicit TileDownloader(QObject* parent = nullptr);
+
+    /**
+     * @brief Destructeur : annule les requêtes encore en cours.
+     */
+    ~TileDownloader();
+
+    /**
+     * @brief Demande le téléchargement d'une tuile.
+     *
+     * Si la tuile est déjà en attente ou en cours de téléchargement, la demande
+     * est fusionnée avec la requête existante. Les requêtes sont lancées au
+     * retour dans la boucle d'événements, une fois toutes les demandes reçues.
+     * @param key Identifiant de la tuile
+     */
+    void request(const TileKey& key);
+
+    /**
+     * @brief Ajoute une tuile à la file de préchargement.
+     *
+     * Les tuiles de préchargement cèdent la place aux tuiles demandées par
+     * request() et ne sont pas annulées par cancelOutside().
+     * @param key Identifiant de la tuile
+     */
+    void prefetch(const TileKey& key);
+
+    /**
+     * @brief Vide la file de préchargement (les requêtes déjà lancées continuent).
+     */
+    void clearPrefetch();
+
+    /**
+     * @brief Demande la revalidation en arrière-plan d'une tuile périmée.
+     *
+     * La requête est conditionnelle : le résultat est signalé par
+     * tileNotModified() si la tuile n'a pas changé, par tileDownloaded() sinon.
+     * @param key Identifiant de la tuile
+     * @param freshness Validateurs de la copie locale
+     */
+    void revalidate(const TileKey& key, const TileFreshness& freshness);
+
+    /**
+     * @brief Définit la vue courante servant à ordonner la file d'attente.
+     * @param zoom Niveau de zoom de la vue
+     * @param center Centre de la vue en coordonnées de tuile
+     * @param visible Zone visible en coordonnées de tuile
+     */
+    void setViewport(int zoom, const QPointF& center, const QRectF& visible);
+
+    /**
+     * @brief Change de serveur de tuiles.
+     *
+     * Les requêtes en cours sont annulées et une connexion est ouverte
+     * d'avance vers chaque hôte de la source.
+     * @param source Nouvelle source de tuiles
+     */
+    void setSource(const TileSource& source);
+
+    /**
+     * @brief Récupère la source de tuiles.
+     * @return Source courante
+     */
+    const TileSource& source() const;
+
+    /**
+     * @brief Définit le nombre maximal de requêtes simultanées.
+     * @param maxConcurrent Nombre de requêtes (au moins 1)
+     */
+    void setMaxConcurrent(int maxConcurrent);
+
+    /**
+     * @brief Annule les téléchargements des tuiles qui ne sont plus nécessaires.
+     * @param zoom Niveau de zoom courant
+     * @param range Plage de tuiles à conserver pour ce niveau de zoom
+     */
+    void cancelOutside(int zoom, const QRect& range);
+
+    /**
+     * @brief Annule les téléchargements des tuiles qui ne sont plus nécessaires à aucune vue.
+     * @param ranges Plages de tuiles à conserver, par niveau de zoom
+     */
+    void cancelOutside(const QHash<int, QRect>& ranges);
+
+    /**
+     * @brief Annule tous les téléchargements en cours.
+     */
+    void cancelAll();
+
+    /**
+     * @brief Vérifie si une tuile est en échec et ne doit pas encore être redemandée.
+     * @param key Identifiant de la tuile
+     * @return Vrai tant que le délai de relance de la tuile n'est pas écoulé
+     */
+    bool isBackingOff(const TileKey& key) const;
+
+    /**
+     * @brief Vérifie si une tuile est en attente ou en cours de téléchargement.
+     * @param key Identifiant de la tuile
+     * @return Vrai si la tuile est en attente ou en cours de téléchargement
+     */
+    bool isPending(const TileKey& key) const;
+
+    /**
+     * @brief Récupère le nombre de téléchargements en attente ou en cours.
+     * @return Nombre de tuiles en attente
+     */
+    int pendingCount() const;
+
+signals:
+    /**
+     * @brief Signal émis lorsqu'une tuile a été téléchargée.
+     * @param key Identifiant de la tuile
+     * @param data Données PNG de la tuile
+     * @param freshness Validateurs et fin de validité de la réponse
+     */
+    void tileDownloaded(const TileKey& key, const QByteArray& data, const TileFreshness& freshness);
+
+    /**
+     * @brief Signal émis lorsque le serveur confirme qu'une tuile revalidée n'a pas changé.
+     * @param key Identifiant de la tuile
+     * @param freshness Nouvelle fraîcheur (validateurs vides s'ils n'ont pas été renvoyés)
+     */
+    void tileNotModified(const TileKey& key, const TileFreshness& freshness);
+
+    /**
+     * @brief Signal émis lorsque le téléchargement d'une tuile a échoué.
+     * @param key Identifiant de la tuile
+     * @param errorMessage Message d'erreur
+     */
+    void tileFailed(const TileKey& key, const QString& errorMessage);
+
+private:
+    /**
+     * @brief Programme le lancement des requêtes au retour dans la boucle d'événements.
+     */
+    void scheduleDispatch();
+
+    /**
+     * @brief Lance les requêtes les plus prioritaires dans la limite de simultanéité.
+     */
+    void dispatch();
+
+    /**
+     * @brief Recherche dans une file la première tuile dont l'hôte accepte une requête.
+     * @param queue File à parcourir
+     * @param mostUrgentLast Vrai si la tuile la plus urgente est en fin de file
+     * @return Position de la tuile, ou -1 si tous les hôtes concernés sont en pause
+     */
+    int nextStartable(const QVector<TileKey>& queue, bool mostUrgentLast);
+
+    /**
+     * @brief Construit l'URL d'une tuile.
+     * @param key Identifiant de la tuile
+     * @return URL de la tuile sur le serveur
+     */
+    QUrl tileUrl(const TileKey& key) const;
+
+    /**
+     * @brief Vérifie si le disjoncteur d'un hôte laisse passer une requête.
+     *
+     * À la fin d'une pause, une seule requête d'essai est autorisée.
+     * @param host Nom de l'hôte
+     * @return Vrai si la requête peut partir
+     */
+    bool acquireHost(const QString& host);
+
+    /**
+     * @brief Enregistre l'échec d'une tuile et programme sa relance.
+     * @param key Identifiant de la tuile
+     * @param reply Réponse en erreur
+     */
+    void recordFailure(const TileKey& key, QNetworkReply* reply);
+
+    /**
+     * @brief Enregistre le résultat d'une requête pour le disjoncteur de son hôte.
+     * @param host Nom de l'hôte
+     * @param success Indique si le serveur a répondu normalement
+     */
+    void recordHostResult(const QString& host, bool success);
+
+    /**
+     * @brief Programme le minuteur de relance sur la prochaine échéance.
+     */
+    void scheduleRetry();
+
+    /**
+     * @brief Relance les tuiles dont le délai est écoulé et qui sont encore visibles.
+     */
+    void onRetryTimer();
+
+    /**
+     * @brief Envoie la requête réseau d'une tuile.
+     * @param key Identifiant de la tuile
+     */
+    void startRequest(const TileKey& key);
+
+    /**
+     * @brief Calcule la priorité d'une tuile par rapport à la vue courante.
+     * @param key Identifiant de la tuile
+     * @return Priorité (plus la valeur est petite, plus la tuile est urgente)
+     */
+    double priorityOf(const TileKey& key) const;
+
+    /**
+     * @brief Extrait d'une réponse les validateurs et la fin de validité.
+     *
+     * La validité vient de Cache-Control (max-age), sinon de Expires, sinon
+     * de la durée par défaut.
+     * @param reply Réponse du serveur
+     * @return Fraîcheur de la réponse
+     */
+    static TileFreshness freshnessOf(QNetworkReply* reply);
+
+    /**
+     * @brief Traite la fin d'une requête de tuile.
+     * @param key Identifiant de la tuile associée à la requête
+     * @param reply Réponse du serveur
+     */
+    void onReplyFinished(const TileKey& key, QNetworkReply* reply);
+};
+
+#endif // TILEDOWNLOADER_H
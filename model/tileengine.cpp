@@ -0,0 +1,363 @@
+// tileengine.cpp
+#include "tileengine.h"
+#include "model/filetilestore.h"
+#include "model/mbtilesstore.h"
+
+#include <QDebug>
+#include <QStandardPaths>
+
+namespace {
+
+const int kLocalPrefetchBatch = 4; ///< Tuiles préchargées localement à chaque fois que le disque et le décodeur sont libres
+const bool kPackedTileStore = true; ///< Cache disque dans un seul fichier MBTiles plutôt qu'un fichier par tuile
+
+/**
+ * @brief Crée le stockage du cache disque des tuiles d'une source.
+ *
+ * Chaque source a son propre cache, nommé d'après elle. Le stockage en un
+ * seul fichier importe au premier lancement les tuiles de l'ancien
+ * répertoire « un fichier par tuile ».
+ * @param source Source des tuiles stockées
+ */
+TileStore* createTileStore(const TileSource& source)
+{
+    QString basePath = QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+        + "/" + source.name() + "_tiles";
+    if (kPackedTileStore)
+        return new MbTilesStore(basePath + ".mbtiles", source.name(), basePath);
+    return new FileTileStore(basePath);
+}
+
+/**
+ * @brief Moteurs existants, indexés par nom de source.
+ */
+QHash<QString, QWeakPointer<TileEngine>>& engines()
+{
+    static QHash<QString, QWeakPointer<TileEngine>> engines;
+    return engines;
+}
+
+/**
+ * @brief Chemins des archives hors ligne ouvertes, indexés par nom de source.
+ *
+ * Les archives survivent ainsi aux moteurs, détruits avec leur dernier abonné.
+ */
+QHash<QString, QString>& archivePaths()
+{
+    static QHash<QString, QString> archivePaths;
+    return archivePaths;
+}
+
+} // namespace
+
+TileEngine::TileEngine(const TileSource& source, QObject* parent)
+    : QObject(parent)
+    , _diskCache(createTileStore(source))
+    , _tileCache(64 * 1024 * 1024)
+    , _nextClient(0)
+{
+    _downloader.setSource(source);
+
+    connect(&_downloader, &TileDownloader::tileDownloaded, this, &TileEngine::onTileDownloaded);
+    connect(&_downloader, &TileDownloader::tileNotModified, &_diskCache, &TileDiskCache::refresh);
+    connect(&_downloader, &TileDownloader::tileFailed, this, &TileEngine::tileFailed);
+    connect(&_diskCache, &TileDiskCache::tileRead, this, &TileEngine::onTileRead);
+    connect(&_diskCache, &TileDiskCache::tileMissing, this, &TileEngine::onTileMissing);
+    connect(&_diskCache, &TileDiskCache::tileExpired, &_downloader, &TileDownloader::revalidate);
+    connect(&_decoder, &TileDecoder::tilesDecoded, this, &TileEngine::onTilesDecoded);
+}
+
+QSharedPointer<TileEngine> TileEngine::forSource(const TileSource& source)
+{
+    QSharedPointer<TileEngine> engine = engines().value(source.name()).toStrongRef();
+    if (engine.isNull()) {
+        engine = QSharedPointer<TileEngine>(new TileEngine(source));
+        engines().insert(source.name(), engine);
+
+        // Rouvrir l'archive hors ligne déjà ouverte par un moteur précédent de la source
+        QString archivePath = archivePaths().value(source.name());
+        if (!archivePath.isEmpty())
+            engine->openArchive(archivePath);
+    }
+    return engine;
+}
+
+TileEngine::~TileEngine()
+{
+    // L'entrée expirée ne servirait plus : une source utilisée une seule fois ne reste pas dans le registre
+    auto it = engines().find(source().name());
+    if (it != engines().end() && it->isNull())
+        engines().erase(it);
+}
+
+const TileSource& TileEngine::source() const
+{
+    return _downloader.source();
+}
+
+int TileEngine::subscribe()
+{
+    return _nextClient++;
+}
+
+void TileEngine::unsubscribe(int client)
+{
+    _viewports.remove(client);
+    if (_prefetch.remove(client))
+        rebuildPrefetch();
+    cancelUnwanted();
+}
+
+void TileEngine::setViewport(int client, int zoom, const QRect& range, const QPointF& center, const QRectF& visible)
+{
+    setRange(client, zoom, range);
+    _downloader.setViewport(zoom, center, visible);
+}
+
+void TileEngine::setRange(int client, int zoom, const QRect& range)
+{
+    Viewport& viewport = _viewports[client];
+    viewport.zoom = zoom;
+    viewport.range = range;
+
+    cancelUnwanted();
+}
+
+void TileEngine::setPrefetch(int client, const QVector<TileKey>& keys)
+{
+    // La liste est recalculée à chaque pas du glissement, souvent identique
+    auto it = _prefetch.constFind(client);
+    if (it != _prefetch.constEnd() && *it == keys)
+        return;
+
+    _prefetch[client] = keys;
+    rebuildPrefetch();
+}
+
+void TileEngine::rebuildPrefetch()
+{
+    // La file de préchargement est reconstruite à partir des listes de tous les abonnés
+    _downloader.clearPrefetch();
+    _prefetchKeys.clear();
+    _localPrefetch.clear();
+    for (const QVector<TileKey>& list : qAsConst(_prefetch)) {
+        for (const TileKey& key : list) {
+            if (_prefetchKeys.contains(key))
+                continue;
+            _prefetchKeys.insert(key);
+
+            if (_tileCache.contains(key) || isPending(key))
+                continue;
+
+            // Lectures et décodages locaux mis en attente ; le téléchargeur a sa propre file de basse priorité
+            if (_dataCache.contains(key) || _archive.contains(key) || _diskCache.mayContain(key))
+                _localPrefetch.append(key);
+            else
+                _downloader.prefetch(key);
+        }
+    }
+    startLocalPrefetch();
+}
+
+void TileEngine::startLocalPrefetch()
+{
+    // Une lecture ou un décodage en cours peut concerner une tuile visible : attendre qu'il se termine
+    if (!_diskCache.isIdle() || !_decoder.isIdle())
+        return;
+
+    // Petits lots : une tuile visible demandée entre-temps n'attend qu'un lot
+    int started = 0;
+    while (started < kLocalPrefetchBatch && !_localPrefetch.isEmpty()) {
+        TileKey key = _localPrefetch.takeFirst();
+        if (_tileCache.contains(key) || isPending(key))
+            continue;
+        if (loadLocal(key))
+            started++;
+        else
+            _downloader.prefetch(key);
+    }
+}
+
+void TileEngine::load(const TileKey& key)
+{
+    // Une tuile déjà en cours de lecture, de téléchargement ou de décodage n'est pas redemandée
+    if (isPending(key))
+        return;
+
+    // Données PNG encore en mémoire : seul le décodage reste à faire
+    if (loadFromDataCache(key))
+        return;
+
+    // L'archive hors ligne passe avant le disque : une recherche dans l'index projeté
+    if (loadFromArchive(key))
+        return;
+
+    // Consulter l'index du cache disque (sans appel système) avant le réseau
+    if (_diskCache.mayContain(key)) {
+        _diskCache.read(key);
+        return;
+    }
+
+    // Télécharger la tuile (fusionné avec une éventuelle requête déjà en cours)
+    _downloader.request(key);
+}
+
+bool TileEngine::loadLocal(const TileKey& key)
+{
+    // Une tuile déjà en route servira aussi à son arrivée
+    if (isPending(key))
+        return true;
+    if (loadFromDataCache(key) || loadFromArchive(key))
+        return true;
+    if (!_diskCache.mayContain(key))
+        return false;
+
+    _diskCache.read(key);
+    return true;
+}
+
+QImage TileEngine::find(const TileKey& key)
+{
+    return _tileCache.find(key);
+}
+
+bool TileEngine::contains(const TileKey& key) const
+{
+    return _tileCache.contains(key);
+}
+
+bool TileEngine::isPending(const TileKey& key) const
+{
+    return _diskCache.isPending(key) || _downloader.isPending(key) || _decoder.isPending(key);
+}
+
+bool TileEngine::isBackingOff(const TileKey& key) const
+{
+    return _downloader.isBackingOff(key);
+}
+
+bool TileEngine::openArchive(const QString& path)
+{
+    // Des décodages peuvent encore référencer la projection : elle n'est jamais remplacée
+    if (_archive.isOpen())
+        return false;
+
+    if (!_archive.open(path)) {
+        qDebug() << "Archive de tuiles illisible:" << path;
+        return false;
+    }
+    archivePaths().insert(source().name(), path);
+    return true;
+}
+
+void TileEngine::setTileCacheSize(qint64 maxBytes)
+{
+    _tileCache.setMaxBytes(maxBytes);
+}
+
+void TileEngine::setTileDataCacheSize(qint64 maxBytes)
+{
+    _dataCache.setMaxBytes(maxBytes);
+}
+
+void TileEngine::setDiskCacheSize(qint64 maxBytes)
+{
+    _diskCache.setMaxBytes(maxBytes);
+}
+
+bool TileEngine::isWanted(const TileKey& key) const
+{
+    for (const Viewport& viewport : _viewports) {
+        if (viewport.zoom == key.zoom && viewport.range.contains(key.x, key.y))
+            return true;
+    }
+    return false;
+}
+
+void TileEngine::cancelUnwanted()
+{
+    // Plages à conserver par niveau de zoom, avec une marge pour ne pas annuler les
+    // tuiles du bord lors de petits déplacements
+    QHash<int, QRect> ranges;
+    for (const Viewport& viewport : qAsConst(_viewports)) {
+        QRect& range = ranges[viewport.zoom];
+        range = range.united(viewport.range.adjusted(-2, -2, 2, 2));
+    }
+    _downloader.cancelOutside(ranges);
+}
+
+bool TileEngine::loadFromDataCache(const TileKey& key)
+{
+    QByteArray data = _dataCache.find(key);
+    if (data.isEmpty())
+        return false;
+
+    // Promotion vers le cache des tuiles décodées, en arrière-plan ; rien à réécrire sur le disque
+    _decoder.decode(key, data, true);
+    return true;
+}
+
+bool TileEngine::loadFromArchive(const TileKey& key)
+{
+    QByteArray data = _archive.find(key);
+    if (data.isEmpty())
+        return false;
+
+    // Traitée comme une lecture locale : jamais réécrite dans le cache disque
+    _decoder.decode(key, data, true);
+    return true;
+}
+
+void TileEngine::onTileDownloaded(const TileKey& key, const QByteArray& data, const TileFreshness& freshness)
+{
+    _dataCache.insert(key, data);
+
+    // Décoder l'image hors du thread graphique
+    _decoder.decode(key, data, false, freshness);
+}
+
+void TileEngine::onTileRead(const TileKey& key, const QByteArray& data)
+{
+    _dataCache.insert(key, data);
+    _decoder.decode(key, data, true);
+}
+
+void TileEngine::onTileMissing(const TileKey& key)
+{
+    // Un remplacement introuvable sur le disque n'est jamais téléchargé pour autant
+    if (isWanted(key))
+        _downloader.request(key);
+    else if (_prefetchKeys.contains(key))
+        _downloader.prefetch(key);
+
+    emit tileMissing(key);
+    startLocalPrefetch();
+}
+
+void TileEngine::onTilesDecoded(const QVector<DecodedTile>& tiles)
+{
+    for (const DecodedTile& decoded : tiles) {
+        const TileKey& key = decoded.key;
+
+        if (decoded.image.isNull()) {
+            // Fichier local illisible : retélécharger la tuile si elle est encore utile ;
+            // tuile téléchargée illisible : la signaler comme un échec de téléchargement
+            _dataCache.remove(key);
+            if (decoded.fromDisk)
+                onTileMissing(key);
+            else
+                emit tileFailed(key, QString("Tuile reçue illisible"));
+            continue;
+        }
+
+        // Sauvegarder la tuile téléchargée dans le cache disque, en arrière-plan
+        if (!decoded.fromDisk)
+            _diskCache.write(key, decoded.data, decoded.freshness);
+
+        _tileCache.insert(key, decoded.image);
+        emit tileReady(key, decoded.image);
+    }
+
+    // Le décodeur s'est peut-être libéré : poursuivre le préchargement local
+    startLocalPrefetch();
+}
@@ -0,0 +1,299 @@
+// tileengine.h
+#ifndef TILEENGINE_H
+#define TILEENGINE_H
+
+#include "model/tilearchive.h"
+#include "model/tilecache.h"
+#include "model/tiledatacache.h"
+#include "model/tiledecoder.h"
+#include "model/tilediskcache.h"
+#include "model/tiledownloader.h"
+#include "model/tilekey.h"
+#include "model/tilesource.h"
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QRect>
+#include <QSet>
+#include <QSharedPointer>
+#include <QVector>
+
+/**
+ * @class TileEngine
+ * @brief Chaîne de chargement des tuiles d'une source, partagée par tout le processus.
+ *
+ * Un seul moteur existe par source de tuiles : toutes les vues (cartes,
+ * calques, vue d'ensemble) qui affichent la même source partagent son
+ * téléchargeur, son décodeur, son archive hors ligne et ses caches. Une
+ * tuile n'est ainsi téléchargée et décodée qu'une fois par processus.
+ *
+ * Chaque consommateur s'abonne au moteur et lui indique sa vue. Une tuile
+ * reste utile tant qu'au moins une vue abonnée la couvre : ses
+ * téléchargements ne sont annulés qu'une fois sortie de toutes les vues.
+ * Les tuiles décodées sont annoncées à tous les abonnés, qui gardent celles
+ * de leur vue.
+ *
+ * Le moteur est compté par références : il est détruit lorsque le dernier
+ * pointeur obtenu par forSource() disparaît. Il ne s'utilise que depuis le
+ * thread graphique.
+ */
+class TileEngine : public QObject {
+    Q_OBJECT
+
+private:
+    /**
+     * @struct Viewport
+     * @brief Vue d'un abonné.
+     */
+    struct Viewport {
+        int zoom = -1; ///< Niveau de zoom de la vue
+        QRect range; ///< Plage de tuiles couverte par la vue
+    };
+
+    TileDownloader _downloader; ///< Téléchargement des tuiles absentes des caches
+    TileArchive _archive; ///< Archive hors ligne en lecture seule, détruite après le décodeur qui la lit
+    TileDecoder _decoder; ///< Décodage des tuiles hors du thread graphique
+    TileDiskCache _diskCache; ///< Cache disque de la source, accédé en arrière-plan
+    TileCache _tileCache; ///< Cache mémoire LRU des tuiles décodées (zone de travail)
+    TileDataCache _dataCache; ///< Cache mémoire LRU des données PNG, décodées à la demande
+    QHash<int, Viewport> _viewports; ///< Vues des abonnés, par identifiant d'abonné
+    QHash<int, QVector<TileKey>> _prefetch; ///< Tuiles à précharger, par identifiant d'abonné
+    QSet<TileKey> _prefetchKeys; ///< Ensemble des tuiles à précharger, tous abonnés confondus
+    QVector<TileKey> _localPrefetch; ///< Tuiles à précharger depuis la mémoire, l'archive ou le disque, pas encore lancées
+    int _nextClient; ///< Identifiant du prochain abonné
+
+public:
+    /**
+     * @brief Récupère le moteur d'une source, créé au premier appel.
+     *
+     * Les sources sont identifiées par leur nom : la première description
+     * d'une source fixe ses paramètres tant que son moteur existe.
+     * @param source Source des tuiles
+     * @return Moteur partagé de la source
+     */
+    static QSharedPointer<TileEngine> forSource(const TileSource& source);
+
+    /**
+     * @brief Destructeur : retire le moteur du registre des sources.
+     */
+    ~TileEngine() override;
+
+    /**
+     * @brief Récupère la source des tuiles du moteur.
+     * @return Source du moteur
+     */
+    const TileSource& source() const;
+
+    /**
+     * @brief Abonne un nouveau consommateur au moteur.
+     * @return Identifiant de l'abonné
+     */
+    int subscribe();
+
+    /**
+     * @brief Désabonne un consommateur : sa vue et ses préchargements sont oubliés.
+     * @param client Identifiant de l'abonné
+     */
+    void unsubscribe(int client);
+
+    /**
+     * @brief Définit la vue d'un abonné.
+     *
+     * Les téléchargements des tuiles sorties de toutes les vues sont
+     * annulés, et la file d'attente est ordonnée depuis le centre de cette
+     * vue, devenue la vue active.
+     * @param client Identifiant de l'abonné
+     * @param zoom Niveau de zoom de la vue
+     * @param range Plage de tuiles couverte par la vue
+     * @param center Centre de la vue en coordonnées de tuile
+     * @param visible Zone visible en coordonnées de tuile
+     */
+    void setViewport(int client, int zoom, const QRect& range, const QPointF& center, const QRectF& visible);
+
+    /**
+     * @brief Définit la plage couverte par un abonné secondaire (vue d'ensemble, etc.).
+     *
+     * Les tuiles de la plage restent utiles, mais l'ordre des téléchargements
+     * continue de suivre la vue active.
+     * @param client Identifiant de l'abonné
+     * @param zoom Niveau de zoom de la plage
+     * @param range Plage de tuiles couverte par l'abonné
+     */
+    void setRange(int client, int zoom, const QRect& range);
+
+    /**
+     * @brief Remplace la liste des tuiles à précharger d'un abonné.
+     * @param client Identifiant de l'abonné
+     * @param keys Tuiles à précharger, la plus utile en premier
+     */
+    void setPrefetch(int client, const QVector<TileKey>& keys);
+
+    /**
+     * @brief Charge une tuile depuis le cache de données, l'archive, le disque ou le serveur.
+     *
+     * Une tuile déjà en cours de lecture, de téléchargement ou de décodage
+     * n'est pas redemandée.
+     * @param key Identifiant de la tuile
+     */
+    void load(const TileKey& key);
+
+    /**
+     * @brief Charge une tuile seulement si elle est disponible localement (jamais sur le réseau).
+     * @param key Identifiant de la tuile
+     * @return Vrai si la tuile est en route ou le sera bientôt
+     */
+    bool loadLocal(const TileKey& key);
+
+    /**
+     * @brief Recherche une tuile décodée et la marque comme récemment utilisée.
+     * @param key Identifiant de la tuile
+     * @return La tuile, dans son format compact, ou une image nulle si elle est absente
+     */
+    QImage find(const TileKey& key);
+
+    /**
+     * @brief Vérifie si une tuile décodée est en cache sans modifier l'ordre LRU.
+     * @param key Identifiant de la tuile
+     * @return Vrai si la tuile est en cache
+     */
+    bool contains(const TileKey& key) const;
+
+    /**
+     * @brief Vérifie si une tuile est en cours de lecture, de téléchargement ou de décodage.
+     * @param key Identifiant de la tuile
+     * @return Vrai si la tuile est en route
+     */
+    bool isPending(const TileKey& key) const;
+
+    /**
+     * @brief Vérifie si une tuile est en échec et ne doit pas encore être redemandée.
+     * @param key Identifiant de la tuile
+     * @return Vrai tant que le délai de relance de la tuile n'est pas écoulé
+     */
+    bool isBackingOff(const TileKey& key) const;
+
+    /**
+     * @brief Ouvre une archive de tuiles pré-rendues, consultée avant le cache disque et le réseau.
+     *
+     * L'archive reste attachée au nom de la source : un moteur recréé pour
+     * la même source (après un changement de source) la rouvre.
+     * @param path Chemin de l'archive
+     * @return Vrai si l'archive a été ouverte (une seule archive par moteur)
+     */
+    bool openArchive(const QString& path);
+
+    /**
+     * @brief Définit le budget mémoire du cache de tuiles décodées.
+     * @param maxBytes Budget mémoire en octets
+     */
+    void setTileCacheSize(qint64 maxBytes);
+
+    /**
+     * @brief Définit le budget mémoire du cache de données PNG.
+     * @param maxBytes Budget mémoire en octets
+     */
+    void setTileDataCacheSize(qint64 maxBytes);
+
+    /**
+     * @brief Définit le quota d'occupation du cache disque.
+     * @param maxBytes Quota en octets
+     */
+    void setDiskCacheSize(qint64 maxBytes);
+
+signals:
+    /**
+     * @brief Signal émis lorsqu'une tuile vient d'être décodée.
+     * @param key Identifiant de la tuile
+     * @param tile Tuile décodée, dans son format compact
+     */
+    void tileReady(const TileKey& key, const QImage& tile);
+
+    /**
+     * @brief Signal émis lorsqu'une tuile est absente du disque ou illisible.
+     * @param key Identifiant de la tuile
+     */
+    void tileMissing(const TileKey& key);
+
+    /**
+     * @brief Signal émis lorsque le téléchargement d'une tuile a échoué.
+     * @param key Identifiant de la tuile
+     * @param errorMessage Message d'erreur
+     */
+    void tileFailed(const TileKey& key, const QString& errorMessage);
+
+private:
+    /**
+     * @brief Constructeur du moteur (voir forSource()).
+     * @param source Source des tuiles
+     * @param parent Objet parent
+     */
+    explicit TileEngine(const TileSource& source, QObject* parent = nullptr);
+
+    /**
+     * @brief Indique si une tuile est couverte par la vue d'au moins un abonné.
+     * @param key Identifiant de la tuile
+     * @return Vrai si la tuile est encore utile
+     */
+    bool isWanted(const TileKey& key) const;
+
+    /**
+     * @brief Annule les téléchargements des tuiles sorties de toutes les vues.
+     */
+    void cancelUnwanted();
+
+    /**
+     * @brief Reconstruit la file de préchargement à partir des listes de tous les abonnés.
+     */
+    void rebuildPrefetch();
+
+    /**
+     * @brief Lance le lot suivant du préchargement local si aucune lecture ni aucun décodage n'est en cours.
+     *
+     * Les tuiles visibles passent ainsi devant le préchargement dans le
+     * thread d'entrées/sorties et dans le pool de décodage.
+     */
+    void startLocalPrefetch();
+
+    /**
+     * @brief Lance le décodage d'une tuile si ses données PNG sont en mémoire.
+     * @param key Identifiant de la tuile
+     * @return Vrai si les données de la tuile ont été trouvées
+     */
+    bool loadFromDataCache(const TileKey& key);
+
+    /**
+     * @brief Lance le décodage d'une tuile si elle est dans l'archive hors ligne.
+     * @param key Identifiant de la tuile
+     * @return Vrai si la tuile a été trouvée dans l'archive
+     */
+    bool loadFromArchive(const TileKey& key);
+
+    /**
+     * @brief Traite une tuile téléchargée.
+     * @param key Identifiant de la tuile
+     * @param data Données PNG de la tuile
+     * @param freshness Validateurs et fin de validité de la réponse
+     */
+    void onTileDownloaded(const TileKey& key, const QByteArray& data, const TileFreshness& freshness);
+
+    /**
+     * @brief Traite une tuile lue depuis le cache disque.
+     * @param key Identifiant de la tuile
+     * @param data Données PNG de la tuile
+     */
+    void onTileRead(const TileKey& key, const QByteArray& data);
+
+    /**
+     * @brief Traite une tuile absente du cache disque : téléchargée si elle est encore utile.
+     * @param key Identifiant de la tuile
+     */
+    void onTileMissing(const TileKey& key);
+
+    /**
+     * @brief Ajoute au cache les tuiles décodées et les annonce aux abonnés.
+     * @param tiles Tuiles décodées
+     */
+    void onTilesDecoded(const QVector<DecodedTile>& tiles);
+};
+
+#endif // TILEENGINE_H
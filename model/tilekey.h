@@ -0,0 +1,54 @@
+// tilekey.h
+#ifndef TILEKEY_H
+#define TILEKEY_H
+
+#include <QHash>
+
+/**
+ * @struct TileKey
+ * @brief Identifiant d'une tuile cartographique.
+ *
+ * Une tuile est identifiée de manière unique par son niveau de zoom
+ * et ses coordonnées (x, y) dans la grille de ce niveau.
+ */
+struct TileKey {
+    int zoom; ///< Niveau de zoom
+    int x; ///< Coordonnée X de la tuile
+    int y; ///< Coordonnée Y de la tuile
+};
+
+/**
+ * @brief Compare deux identifiants de tuile.
+ * @param a Première tuile
+ * @param b Seconde tuile
+ * @return Vrai si les deux tuiles sont identiques
+ */
+inline bool operator==(const TileKey& a, const TileKey& b)
+{
+    return a.zoom == b.zoom && a.x == b.x && a.y == b.y;
+}
+
+/**
+ * @brief Compare deux identifiants de tuile.
+ * @param a Première tuile
+ * @param b Seconde tuile
+ * @return Vrai si les deux tuiles sont différentes
+ */
+inline bool operator!=(const TileKey& a, const TileKey& b)
+{
+    return !(a == b);
+}
+
+/**
+ * @brief Calcule la valeur de hachage d'un identifiant de tuile.
+ * @param key Identifiant de la tuile
+ * @param seed Graine de hachage
+ * @return Valeur de hachage
+ */
+inline uint qHash(const TileKey& key, uint seed = 0)
+{
+    // x et y tiennent sur 24 bits jusqu'au zoom 24
+    return qHash((quint64(key.zoom) << 48) ^ (quint64(key.x) << 24) ^ quint64(key.y), seed);
+}
+
+#endif // TILEKEY_H
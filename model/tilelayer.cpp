@@ -0,0 +1,49 @@
+// tilelayer.cpp
+#include "tilelayer.h"
+
+TileLayer::TileLayer(const TileSource& source, QObject* parent)
+    : QObject(parent)
+    , _engine(TileEngine::forSource(source))
+    , _client(_engine->subscribe())
+    , _opacity(1.0)
+{
+    connect(_engine.data(), &TileEngine::tileReady, this, [this](const TileKey& key) {
+        emit tileReady(key);
+    });
+}
+
+TileLayer::~TileLayer()
+{
+    _engine->unsubscribe(_client);
+}
+
+const TileSource& TileLayer::source() const
+{
+    return _engine->source();
+}
+
+double TileLayer::opacity() const
+{
+    return _opacity;
+}
+
+void TileLayer::setOpacity(double opacity)
+{
+    _opacity = qBound(0.0, opacity, 1.0);
+}
+
+void TileLayer::setViewport(int zoom, const QRect& range, const QPointF& center, const QRectF& visible)
+{
+    _engine->setViewport(_client, zoom, range, center, visible);
+}
+
+void TileLayer::request(const TileKey& key)
+{
+    if (!_engine->contains(key))
+        _engine->load(key);
+}
+
+QImage TileLayer::find(const TileKey& key) const
+{
+    return _engine->find(key);
+}
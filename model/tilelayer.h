@@ -0,0 +1,92 @@
+// tilelayer.h
+#ifndef TILELAYER_H
+#define TILELAYER_H
+
+#include "model/tileengine.h"
+#include "model/tilekey.h"
+#include "model/tilesource.h"
+#include <QImage>
+#include <QObject>
+#include <QRect>
+#include <QSharedPointer>
+
+/**
+ * @class TileLayer
+ * @brief Calque de tuiles superposé au fond de carte (transports, données internes, etc.).
+ *
+ * Chaque calque a sa propre source et son opacité. Ses tuiles sont chargées
+ * et gardées en mémoire par le moteur partagé de sa source : deux vues qui
+ * affichent le même calque ne le téléchargent qu'une fois.
+ *
+ * Une tuile absente du serveur ou en échec reste simplement transparente.
+ */
+class TileLayer : public QObject {
+    Q_OBJECT
+
+private:
+    QSharedPointer<TileEngine> _engine; ///< Moteur partagé de la source du calque
+    int _client; ///< Identifiant d'abonné du calque auprès du moteur
+    double _opacity; ///< Opacité du calque, entre 0 et 1
+
+public:
+    /**
+     * @brief Constructeur d'un calque.
+     * @param source Source des tuiles du calque
+     * @param parent Objet parent
+     */
+    explicit TileLayer(const TileSource& source, QObject* parent = nullptr);
+
+    /**
+     * @brief Destructeur : désabonne le calque du moteur.
+     */
+    ~TileLayer();
+
+    /**
+     * @brief Récupère la source des tuiles du calque.
+     * @return Source du calque
+     */
+    const TileSource& source() const;
+
+    /**
+     * @brief Récupère l'opacité du calque.
+     * @return Opacité, entre 0 et 1
+     */
+    double opacity() const;
+
+    /**
+     * @brief Définit l'opacité du calque.
+     * @param opacity Opacité, entre 0 et 1
+     */
+    void setOpacity(double opacity);
+
+    /**
+     * @brief Définit la vue courante : les téléchargements hors de la plage sont annulés.
+     * @param zoom Niveau de zoom de la vue
+     * @param range Plage de tuiles couverte par la vue
+     * @param center Centre de la vue en coordonnées de tuile
+     * @param visible Zone visible en coordonnées de tuile
+     */
+    void setViewport(int zoom, const QRect& range, const QPointF& center, const QRectF& visible);
+
+    /**
+     * @brief Charge une tuile du calque si elle n'est pas déjà en mémoire ou en route.
+     * @param key Identifiant de la tuile
+     */
+    void request(const TileKey& key);
+
+    /**
+     * @brief Recherche une tuile décodée du calque.
+     * @param key Identifiant de la tuile
+     * @return La tuile, ou une image nulle si elle est absente
+     */
+    QImage find(const TileKey& key) const;
+
+signals:
+    /**
+     * @brief Signal émis lorsqu'une tuile du calque vient d'être décodée.
+     * @param key Identifiant de la tuile
+     */
+    void tileReady(const TileKey& key);
+};
+
+#endif // TILELAYER_H
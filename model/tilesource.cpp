@@ -0,0 +1,115 @@
+// tilesource.cpp
+#include "tilesource.h"
+
+namespace {
+
+const int kRequestsPerHost = 6; ///< Limite de connexions par hôte de QNetworkAccessManager
+const int kSingleHostRequests = 2; ///< Requêtes simultanées par défaut d'une source sans sous-domaines
+
+} // namespace
+
+TileSource::TileSource(const QString& name, const QString& urlTemplate, const QStringList& subdomains)
+    : _name(name)
+    , _urlTemplate(urlTemplate)
+    , _tileSize(256)
+    , _subdomains(subdomains)
+    , _maxConcurrent(subdomains.isEmpty() ? kSingleHostRequests : kRequestsPerHost * subdomains.size())
+    , _userAgent("Qt OSM Map Widget/1.0")
+    , _http2(true)
+{
+}
+
+TileSource TileSource::openStreetMap()
+{
+    // Un User-Agent identifiant l'application est exigé par les conditions d'utilisation d'OpenStreetMap,
+    // qui déconseillent aussi les anciens sous-domaines a, b et c et les téléchargements massifs
+    return TileSource("osm", "https://tile.openstreetmap.org/{z}/{x}/{y}.png");
+}
+
+QString TileSource::name() const
+{
+    return _name;
+}
+
+int TileSource::tileSize() const
+{
+    return _tileSize;
+}
+
+bool TileSource::hasHighDpi() const
+{
+    return _urlTemplate.contains("{r}");
+}
+
+TileSource TileSource::highDpi() const
+{
+    TileSource source(*this);
+    source._name = _name + "@2x";
+    source._scaleSuffix = "@2x";
+    source._tileSize = 512;
+    return source;
+}
+
+int TileSource::maxConcurrent() const
+{
+    return _maxConcurrent;
+}
+
+void TileSource::setMaxConcurrent(int maxConcurrent)
+{
+    _maxConcurrent = qMax(1, maxConcurrent);
+}
+
+void TileSource::setUserAgent(const QByteArray& userAgent)
+{
+    _userAgent = userAgent;
+}
+
+void TileSource::addHeader(const QByteArray& name, const QByteArray& value)
+{
+    _headers.append(qMakePair(name, value));
+}
+
+void TileSource::setHttp2Enabled(bool enabled)
+{
+    _http2 = enabled;
+}
+
+QStringList TileSource::hosts() const
+{
+    QStringList hosts;
+    const QStringList subdomains = _subdomains.isEmpty() ? QStringList(QString()) : _subdomains;
+    for (const QString& subdomain : subdomains) {
+        QString host = QUrl(QString(_urlTemplate).replace("{s}", subdomain)).host();
+        if (!hosts.contains(host))
+            hosts.append(host);
+    }
+    return hosts;
+}
+
+QUrl TileSource::url(const TileKey& key) const
+{
+    QString url = _urlTemplate;
+
+    // Sous-domaine fixe pour une tuile donnée, alterné entre tuiles voisines
+    if (!_subdomains.isEmpty())
+        url.replace("{s}", _subdomains.at((key.x + key.y) % _subdomains.size()));
+
+    url.replace("{z}", QString::number(key.zoom));
+    url.replace("{x}", QString::number(key.x));
+    url.replace("{y}", QString::number(key.y));
+    url.replace("{r}", _scaleSuffix);
+    return QUrl(url);
+}
+
+QNetworkRequest TileSource::request(const TileKey& key) const
+{
+    QNetworkRequest request(url(key));
+    request.setHeader(QNetworkRequest::UserAgentHeader, _userAgent);
+    for (const QPair<QByteArray, QByteArray>& header : _headers)
+        request.setRawHeader(header.first, header.second);
+
+    // Avec HTTP/2, les requêtes d'un hôte partagent une seule connexion multiplexée
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, _http2);
+    return request;
+}
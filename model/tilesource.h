@@ -0,0 +1,143 @@
+// tilesource.h
+#ifndef TILESOURCE_H
+#define TILESOURCE_H
+
+#include "model/tilekey.h"
+#include <QByteArray>
+#include <QList>
+#include <QNetworkRequest>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QUrl>
+
+/**
+ * @class TileSource
+ * @brief Description d'un serveur de tuiles.
+ *
+ * L'URL d'une tuile est construite à partir d'un modèle dont les variables
+ * {z}, {x} et {y} sont remplacées par les coordonnées de la tuile, et {s} par
+ * l'un des sous-domaines. Le sous-domaine dépend de la tuile : la charge est
+ * répartie entre les hôtes, et une même tuile est toujours demandée au même
+ * hôte (les caches HTTP intermédiaires restent efficaces).
+ *
+ * Une source qui propose des tuiles haute densité (512 pixels) le signale
+ * par la variable {r} de son modèle, remplacée par « @2x » pour ces tuiles et
+ * supprimée sinon. highDpi() en donne la variante haute densité.
+ *
+ * Chaque source a son nombre maximal de requêtes simultanées, son
+ * User-Agent et ses en-têtes ; HTTP/2 est proposé au serveur, qui peut alors
+ * multiplexer les requêtes sur une seule connexion par hôte.
+ */
+class TileSource {
+private:
+    QString _name; ///< Nom court de la source, utilisé pour nommer son cache disque
+    QString _urlTemplate; ///< Modèle d'URL ({s}, {z}, {x}, {y}, {r})
+    QString _scaleSuffix; ///< Texte substitué à {r} (« @2x » pour les tuiles haute densité)
+    int _tileSize; ///< Taille des tuiles servies, en pixels
+    QStringList _subdomains; ///< Sous-domaines substitués à {s}
+    int _maxConcurrent; ///< Nombre maximal de requêtes simultanées pour cette source
+    QByteArray _userAgent; ///< User-Agent envoyé au serveur
+    QList<QPair<QByteArray, QByteArray>> _headers; ///< En-têtes supplémentaires
+    bool _http2; ///< Indique si HTTP/2 est proposé au serveur
+
+public:
+    /**
+     * @brief Constructeur d'une source de tuiles.
+     *
+     * Une source répartie sur des sous-domaines accepte par défaut six
+     * requêtes simultanées par hôte ; une source sur un seul hôte, deux.
+     * @param name Nom court de la source (caractères autorisés dans un nom de fichier)
+     * @param urlTemplate Modèle d'URL, par exemple « https://{s}.tile.example.org/{z}/{x}/{y}.png »
+     * @param subdomains Sous-domaines substitués à {s}
+     */
+    TileSource(const QString& name, const QString& urlTemplate, const QStringList& subdomains = QStringList());
+
+    /**
+     * @brief Crée la source par défaut : le serveur OpenStreetMap.
+     *
+     * Conformément aux conditions d'utilisation des serveurs publics, la
+     * source n'utilise qu'un hôte et deux requêtes simultanées.
+     * @return Source OpenStreetMap
+     */
+    static TileSource openStreetMap();
+
+    /**
+     * @brief Récupère le nom court de la source.
+     * @return Nom de la source
+     */
+    QString name() const;
+
+    /**
+     * @brief Récupère la taille des tuiles servies.
+     * @return Taille en pixels (256, ou 512 pour la variante haute densité)
+     */
+    int tileSize() const;
+
+    /**
+     * @brief Indique si la source propose des tuiles haute densité.
+     * @return Vrai si le modèle d'URL contient {r}
+     */
+    bool hasHighDpi() const;
+
+    /**
+     * @brief Crée la variante haute densité (512 pixels) de la source.
+     *
+     * La variante a son propre nom, et donc son propre cache disque.
+     * @return Source des tuiles « @2x »
+     */
+    TileSource highDpi() const;
+
+    /**
+     * @brief Récupère le nombre maximal de requêtes simultanées.
+     * @return Nombre de requêtes
+     */
+    int maxConcurrent() const;
+
+    /**
+     * @brief Définit le nombre maximal de requêtes simultanées.
+     * @param maxConcurrent Nombre de requêtes (au moins 1)
+     */
+    void setMaxConcurrent(int maxConcurrent);
+
+    /**
+     * @brief Définit le User-Agent envoyé au serveur.
+     * @param userAgent User-Agent
+     */
+    void setUserAgent(const QByteArray& userAgent);
+
+    /**
+     * @brief Ajoute un en-tête envoyé avec chaque requête (clé d'API, etc.).
+     * @param name Nom de l'en-tête
+     * @param value Valeur de l'en-tête
+     */
+    void addHeader(const QByteArray& name, const QByteArray& value);
+
+    /**
+     * @brief Autorise ou non HTTP/2 avec ce serveur.
+     * @param enabled Vrai pour proposer HTTP/2
+     */
+    void setHttp2Enabled(bool enabled);
+
+    /**
+     * @brief Récupère la liste des hôtes de la source, un par sous-domaine.
+     * @return Noms des hôtes
+     */
+    QStringList hosts() const;
+
+    /**
+     * @brief Construit l'URL d'une tuile.
+     * @param key Identifiant de la tuile
+     * @return URL de la tuile
+     */
+    QUrl url(const TileKey& key) const;
+
+    /**
+     * @brief Construit la requête d'une tuile, en-têtes et options compris.
+     * @param key Identifiant de la tuile
+     * @return Requête prête à être envoyée
+     */
+    QNetworkRequest request(const TileKey& key) const;
+};
+
+#endif // TILESOURCE_H
@@ -0,0 +1,110 @@
+// tilestore.h
+#ifndef TILESTORE_H
+#define TILESTORE_H
+
+#include "model/tilekey.h"
+#include <QByteArray>
+#include <QHash>
+#include <QVector>
+
+/**
+ * @struct TileFreshness
+ * @brief Informations de fraîcheur HTTP d'une tuile.
+ *
+ * Les validateurs permettent de redemander la tuile de manière
+ * conditionnelle : si elle n'a pas changé, le serveur répond
+ * « 304 Not Modified » sans renvoyer les données.
+ */
+struct TileFreshness {
+    static constexpr qint64 kDefaultMaxAge = 7 * 24 * 3600; ///< Durée de validité sans en-tête Cache-Control, en secondes
+
+    QByteArray etag; ///< En-tête ETag de la réponse, vide s'il est absent
+    QByteArray lastModified; ///< En-tête Last-Modified de la réponse, vide s'il est absent
+    qint64 expires = 0; ///< Fin de validité, en secondes depuis l'époque Unix
+};
+
+/**
+ * @struct StoredTile
+ * @brief Tuile encodée à enregistrer dans un stockage.
+ */
+struct StoredTile {
+    TileKey key; ///< Identifiant de la tuile
+    QByteArray data; ///< Données PNG de la tuile
+    TileFreshness freshness; ///< Fraîcheur de la tuile
+};
+
+/**
+ * @struct TileRecord
+ * @brief Entrée de l'index d'un stockage de tuiles.
+ */
+struct TileRecord {
+    qint64 size = 0; ///< Taille des données en octets
+    qint64 expires = 0; ///< Fin de validité, en secondes depuis l'époque Unix
+    qint64 lastAccess = 0; ///< Dernier accès, en secondes depuis l'époque Unix
+};
+
+/**
+ * @class TileStore
+ * @brief Interface d'un stockage persistant de tuiles encodées.
+ *
+ * Un stockage n'est utilisé que depuis le thread d'entrées/sorties du cache
+ * disque : ses méthodes peuvent bloquer et n'ont pas à être protégées.
+ */
+class TileStore {
+public:
+    virtual ~TileStore() = default;
+
+    /**
+     * @brief Ouvre (ou crée) le stockage.
+     * @return Vrai si le stockage est utilisable
+     */
+    virtual bool open() = 0;
+
+    /**
+     * @brief Recense les tuiles présentes dans le stockage.
+     * @return Taille, fin de validité et dernier accès de chaque tuile
+     */
+    virtual QHash<TileKey, TileRecord> index() = 0;
+
+    /**
+     * @brief Lit une tuile et ses informations de fraîcheur.
+     * @param key Identifiant de la tuile
+     * @param tile Tuile lue
+     * @return Faux si la tuile est absente
+     */
+    virtual bool read(const TileKey& key, StoredTile& tile) = 0;
+
+    /**
+     * @brief Écrit un lot de tuiles, en remplaçant celles déjà présentes.
+     * @param tiles Tuiles à écrire
+     * @param now Instant de l'écriture, en secondes depuis l'époque Unix
+     * @return Vrai si tout le lot a été écrit
+     */
+    virtual bool write(const QVector<StoredTile>& tiles, qint64 now) = 0;
+
+    /**
+     * @brief Met à jour la fraîcheur de tuiles revalidées, sans toucher à leurs données.
+     *
+     * Un validateur vide conserve la valeur déjà enregistrée.
+     * @param tiles Tuiles revalidées (les données sont ignorées)
+     * @return Vrai si la mise à jour a réussi
+     */
+    virtual bool updateFreshness(const QVector<StoredTile>& tiles) = 0;
+
+    /**
+     * @brief Enregistre le dernier accès d'un lot de tuiles.
+     * @param keys Tuiles lues
+     * @param now Instant de l'accès, en secondes depuis l'époque Unix
+     * @return Vrai si la mise à jour a réussi
+     */
+    virtual bool touch(const QVector<TileKey>& keys, qint64 now) = 0;
+
+    /**
+     * @brief Supprime un lot de tuiles.
+     * @param keys Tuiles à supprimer
+     * @return Vrai si toutes les tuiles ont été supprimées
+     */
+    virtual bool remove(const QVector<TileKey>& keys) = 0;
+};
+
+#endif // TILESTORE_H
@@ -1,43 +1,75 @@
 // mapwidget.cpp
 #include "mapwidget.h"
+#include "model/projection.h"
+#include "view/tilecompositor.h"
 
-#include <QDir>
-#include <QFile>
-#include <QFileInfo>
+#include <QDebug>
 #include <QMouseEvent>
-#include <QNetworkReply>
-#include <QNetworkRequest>
 #include <QPaintEvent>
 #include <QPainter>
 #include <QPixmap>
-#include <QRegExp>
 #include <QResizeEvent>
+#include <QScreen>
+#include <QShowEvent>
 #include <QStandardPaths>
-#include <QUrl>
 #include <QVector>
 #include <QWheelEvent>
+#include <QWindow>
+#include <QtMath>
+#include <algorithm>
 #include <cmath>
 
+namespace {
+
+const double kFrictionTime = 0.325; ///< Constante de temps de la décélération inertielle, en secondes
+const double kMinKineticSpeed = 150.0; ///< Vitesse minimale au relâchement pour lancer l'inertie (px/s)
+const double kStopSpeed = 15.0; ///< Vitesse en dessous de laquelle l'inertie s'arrête (px/s)
+const double kMaxSpeed = 6000.0; ///< Vitesse inertielle maximale (px/s)
+const qint64 kVelocityWindow = 100; ///< Fenêtre de suivi de la vitesse, en millisecondes
+const double kPrefetchLookahead = 0.6; ///< Anticipation du préchargement selon la vitesse, en secondes
+const int kMaxFallbackDepth = 5; ///< Nombre maximal de niveaux remontés pour trouver un ancêtre
+const double kZoomTime = 0.08; ///< Constante de temps de l'animation de zoom, en secondes
+const double kZoomPerNotch = 1.0; ///< Niveaux de zoom par cran de molette (120 unités)
+const char* const kTileArchiveName = "osm_tiles.tilepack"; ///< Nom de l'archive hors ligne livrée avec l'application
+const int kMarkerMargin = 32; ///< Marge autour de la zone redessinée pour les marqueurs qui la chevauchent, en pixels
+
+} // namespace
+
 MapWidget::MapWidget(MapModel* mapModel, MapController* mapController, QWidget* parent)
     : QWidget(parent)
     , _mapModel(mapModel)
     , _mapController(mapController)
-    , _pendingRequests(0)
+    , _compositeCache(64 * 1024 * 1024)
+    , _tileZoom(-1)
+    , _prefetchBudget(128)
+    , _client(-1)
+    , _tileSource(TileSource::openStreetMap())
+    , _pixelRatio(1)
+    , _zoomOffset(0)
+    , _tilePixels(256)
     , _isDragging(false)
-    , _needFullRefresh(true)
+    , _lastFrameTime(0)
+    , _kinetic(false)
+    , _zooming(false)
+    , _zoomTarget(0.0)
 {
-    // Créer le répertoire de cache pour les tuiles
-    QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/osm_tiles";
-    QDir().mkpath(cacheDir);
+    // S'abonner au moteur de tuiles partagé de la source
+    applyTileSource();
 
-    // Configurer le gestionnaire réseau
-    connect(&_networkManager, &QNetworkAccessManager::finished, this,
-        &MapWidget::onTileDownloaded);
+    // Configurer la boucle d'animation
+    _frameTimer.setTimerType(Qt::PreciseTimer);
+    connect(&_frameTimer, &QTimer::timeout, this, &MapWidget::onFrame);
+    _frameClock.start();
 
     // Connecter les signaux du modèle aux slots de la vue
     connect(_mapModel, &MapModel::centerChanged, this, &MapWidget::onCenterChanged);
     connect(_mapModel, &MapModel::zoomChanged, this, &MapWidget::onZoomChanged);
 
+    // Archive hors ligne éventuellement installée avec les données de l'application
+    QString archivePath = QStandardPaths::locate(QStandardPaths::AppDataLocation, kTileArchiveName);
+    if (!archivePath.isEmpty())
+        openTileArchive(archivePath);
+
     loadTiles();
     setMouseTracking(true);
     setFocusPolicy(Qt::StrongFocus);
@@ -45,29 +77,34 @@ MapWidget::MapWidget(MapModel* mapModel, MapController* mapController, QWidget*
 
 void MapWidget::onCenterChanged()
 {
-    _needFullRefresh = true;
+    // Un recentrage extérieur (recherche, etc.) annule le défilement inertiel en cours
+    if (!_isDragging) {
+        _kinetic = false;
+        _dragOffset = QPoint(0, 0);
+    }
+
+    // Le tampon de rendu défile au prochain dessin : seules les bandes exposées seront redessinées
     loadTiles();
     update();
 }
 
 void MapWidget::onZoomChanged()
 {
-    _needFullRefresh = true;
+    // Un changement de niveau de tuiles invalide le tampon de rendu ; dans le même
+    // niveau, seule l'échelle d'affichage change
     loadTiles();
     update();
 }
 
 QPair<double, double> MapWidget::screenToLonLat(const QPoint& screenPos)
 {
-    // Obtenir les données du modèle
-    QPointF center = _mapModel->getCenter();
-    int zoom = _mapModel->getZoom();
+    int zoom = tileZoom();
 
-    // Calculer la tuile centrale avec des coordonnées fractionnaires
-    QPointF centralTileF = lonLatToTileF(center.x(), center.y(), zoom);
+    // Calculer la tuile centrale de la vue affichée avec des coordonnées fractionnaires
+    QPointF centralTileF = viewCenterTile();
 
-    // Taille standard d'une tuile
-    const int tileSize = 256;
+    // Taille d'une tuile à l'écran, à l'échelle d'affichage courante
+    const double tileSize = screenTileSize();
 
     // Position du centre de l'écran
     int centerX = width() / 2;
@@ -78,162 +115,290 @@ QPair<double, double> MapWidget::screenToLonLat(const QPoint& screenPos)
     int pixelDeltaY = screenPos.y() - centerY;
 
     // Calculer la position en tuiles (fractionnaire)
-    double tileDeltaX = pixelDeltaX / static_cast<double>(tileSize);
-    double tileDeltaY = pixelDeltaY / static_cast<double>(tileSize);
+    double tileDeltaX = pixelDeltaX / tileSize;
+    double tileDeltaY = pixelDeltaY / tileSize;
 
     // Calculer la tuile sous le curseur
     double tileX = centralTileF.x() + tileDeltaX;
     double tileY = centralTileF.y() + tileDeltaY;
 
     // Convertir en coordonnées géographiques
-    int n = 1 << zoom;
-    double lon = tileX / n * 360.0 - 180.0;
-    double latRad = atan(sinh(M_PI * (1 - 2 * tileY / n)));
-    double lat = latRad * 180.0 / M_PI;
+    QPointF lonLat = Projection::tileToLonLat(QPointF(tileX, tileY), zoom);
+    return qMakePair(lonLat.x(), lonLat.y());
+}
 
-    return qMakePair(lon, lat);
+MapWidget::~MapWidget()
+{
+    _engine->unsubscribe(_client);
 }
 
-QPoint MapWidget::lonLatToTile(double lon, double lat, int zoom)
+void MapWidget::setTileCacheSize(qint64 maxBytes)
 {
-    int n = 1 << zoom; // 2^zoom
-    int x = static_cast<int>((lon + 180.0) / 360.0 * n);
-    double latRad = lat * M_PI / 180.0;
-    int y = static_cast<int>((1.0 - log(tan(latRad) + 1.0 / cos(latRad)) / M_PI) / 2.0 * n);
-    return QPoint(x, y);
+    _engine->setTileCacheSize(maxBytes);
 }
 
-QPointF MapWidget::lonLatToTileF(double lon, double lat, int zoom)
+void MapWidget::setTileDataCacheSize(qint64 maxBytes)
 {
-    int n = 1 << zoom; // 2^zoom
-    double x = (lon + 180.0) / 360.0 * n;
-    double latRad = lat * M_PI / 180.0;
-    double y = (1.0 - log(tan(latRad) + 1.0 / cos(latRad)) / M_PI) / 2.0 * n;
-    return QPointF(x, y);
+    _engine->setTileDataCacheSize(maxBytes);
 }
 
-QPair<double, double> MapWidget::tileToLonLat(int x, int y, int zoom)
+void MapWidget::setPrefetchBudget(int budget)
 {
-    int n = 1 << zoom;
-    double lon = x / static_cast<double>(n) * 360.0 - 180.0;
-    double latRad = atan(sinh(M_PI * (1 - 2 * y / static_cast<double>(n))));
-    double lat = latRad * 180.0 / M_PI;
-    return qMakePair(lon, lat);
+    _prefetchBudget = qMax(0, budget);
 }
 
-QString MapWidget::tileFilePath(int x, int y, int zoom)
+void MapWidget::setDiskCacheSize(qint64 maxBytes)
 {
-    QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/osm_tiles";
-    return QString("%1/%2-%3-%4.png").arg(cacheDir).arg(zoom).arg(x).arg(y);
+    _engine->setDiskCacheSize(maxBytes);
 }
 
-void MapWidget::downloadTile(int x, int y, int zoom)
+void MapWidget::setTileSource(const TileSource& source)
 {
-    // Vérifier si le fichier existe déjà
-    QString filePath = tileFilePath(x, y, zoom);
-    QFileInfo fileInfo(filePath);
+    _tileSource = source;
+    applyTileSource();
+}
+
+QSharedPointer<TileEngine> MapWidget::tileEngine() const
+{
+    return _engine;
+}
 
-    if (fileInfo.exists()) {
-        // Charger la tuile depuis le fichier local
-        QPixmap tile(filePath);
-        if (!tile.isNull()) {
-            _tiles.append(tile);
-            _tilePositions.append(QPoint(x, y));
-            update();
-            return;
+void MapWidget::applyTileSource()
+{
+    // Écran haute densité : tuiles « @2x » si la source en propose, sinon tuiles du
+    // niveau suivant affichées à demi-taille (quatre tuiles de 256 pixels par tuile logique)
+    bool highDpi = _pixelRatio > 1 && _tileSource.hasHighDpi();
+    TileSource source = highDpi ? _tileSource.highDpi() : _tileSource;
+    _zoomOffset = _pixelRatio > 1 && !highDpi ? 1 : 0;
+    _tilePixels = source.tileSize();
+
+    // Passer au moteur partagé de la nouvelle source ; l'ancien est détruit avec son dernier abonné
+    if (_engine.isNull() || source.name() != _engine->source().name()) {
+        if (!_engine.isNull()) {
+            _engine->unsubscribe(_client);
+            disconnect(_engine.data(), nullptr, this, nullptr);
         }
+
+        _engine = TileEngine::forSource(source);
+        _client = _engine->subscribe();
+        connect(_engine.data(), &TileEngine::tileReady, this, &MapWidget::onTileReady);
+        connect(_engine.data(), &TileEngine::tileMissing, this, &MapWidget::onTileMissing);
+        connect(_engine.data(), &TileEngine::tileFailed, this, &MapWidget::onTileFailed);
+        _compositeCache.clear();
+        emit tileEngineChanged(_engine);
     }
 
-    // Construire l'URL de la tuile
-    // Format: https://a.tile.openstreetmap.org/{z}/{x}/{y}.png
-    QString urlStr = QString("https://a.tile.openstreetmap.org/%1/%2/%3.png")
-                         .arg(zoom)
-                         .arg(x)
-                         .arg(y);
-    QUrl url(urlStr);
-
-    // Créer la requête
-    QNetworkRequest request(url);
-
-    // Ajouter un User-Agent pour respecter les conditions d'utilisation d'OpenStreetMap
-    request.setHeader(QNetworkRequest::UserAgentHeader, "Qt OSM Map Widget/1.0");
-
-    // Envoyer la requête
-    _networkManager.get(request);
-    _pendingRequests++;
-}
-
-void MapWidget::onTileDownloaded(QNetworkReply* reply)
-{
-    // Diminuer le compteur de requêtes en attente
-    _pendingRequests--;
-
-    // Vérifier si la requête a réussi
-    if (reply->error() == QNetworkReply::NoError) {
-        // Extraire les coordonnées de la tuile de l'URL
-        QString urlStr = reply->url().toString();
-        QRegExp rx("/(\\d+)/(\\d+)/(\\d+)\\.png");
-        if (rx.indexIn(urlStr) != -1) {
-            int zoom = rx.cap(1).toInt();
-            int x = rx.cap(2).toInt();
-            int y = rx.cap(3).toInt();
-
-            // Lire les données de l'image
-            QByteArray data = reply->readAll();
-
-            // Créer une image à partir des données
-            QPixmap tile;
-            if (tile.loadFromData(data)) {
-                // Sauvegarder la tuile dans le cache
-                QString filePath = tileFilePath(x, y, zoom);
-                QFile file(filePath);
-                if (file.open(QIODevice::WriteOnly)) {
-                    file.write(data);
-                    file.close();
-                }
+    // Les tuiles affichées ne correspondent plus au niveau ou à la taille des tuiles
+    _tiles.clear();
+    _fallbackKeys.clear();
+    _backbuffer.invalidate();
+    _tileRange = QRect();
+    loadTiles();
+    update();
+}
 
-                // Ajouter la tuile à la liste
-                _tiles.append(tile);
-                _tilePositions.append(QPoint(x, y));
+bool MapWidget::updatePixelRatio()
+{
+    // Rapport arrondi à 1 ou 2 : les tuiles n'existent qu'en 256 et 512 pixels
+    int pixelRatio = devicePixelRatioF() > 1.25 ? 2 : 1;
+    if (pixelRatio == _pixelRatio)
+        return false;
+
+    _pixelRatio = pixelRatio;
+    _backbuffer.resize(backbufferSize());
+    _markerAtlases.clear();
+    applyTileSource();
+    return true;
+}
 
-                // Rafraîchir l'affichage
-            }
-        }
+int MapWidget::addOverlay(const TileSource& source, double opacity)
+{
+    TileLayer* layer = new TileLayer(source, this);
+    layer->setOpacity(opacity);
+    connect(layer, &TileLayer::tileReady, this, &MapWidget::onOverlayTileReady);
+    _overlays.append(layer);
+
+    reloadOverlays();
+    return _overlays.size() - 1;
+}
+
+void MapWidget::removeOverlay(int index)
+{
+    if (index < 0 || index >= _overlays.size())
+        return;
+
+    delete _overlays.takeAt(index);
+    reloadOverlays();
+}
+
+void MapWidget::setOverlayOpacity(int index, double opacity)
+{
+    if (index < 0 || index >= _overlays.size())
+        return;
+
+    _overlays[index]->setOpacity(opacity);
+    reloadOverlays();
+}
+
+int MapWidget::overlayCount() const
+{
+    return _overlays.size();
+}
+
+void MapWidget::addMarkerLayer(MarkerLayer* layer)
+{
+    if (_markerLayers.contains(layer))
+        return;
+
+    // Redessiner la vue à chaque modification du calque ; l'oublier à sa destruction
+    _markerLayers.append(layer);
+    connect(layer, &MarkerLayer::changed, this, [this]() { update(); });
+    connect(layer, &QObject::destroyed, this, [this, layer]() {
+        _markerLayers.removeAll(layer);
         update();
-    } else {
-        qDebug() << "Erreur de téléchargement de tuile:" << reply->errorString();
-    }
+    });
+    update();
+}
+
+void MapWidget::removeMarkerLayer(MarkerLayer* layer)
+{
+    if (!_markerLayers.removeAll(layer))
+        return;
 
-    // Libérer la mémoire
-    reply->deleteLater();
+    disconnect(layer, nullptr, this, nullptr);
+    update();
 }
 
-void MapWidget::loadTiles()
+void MapWidget::reloadOverlays()
 {
-    // Vider les tuiles précédentes
+    // Les tuiles composées ne correspondent plus à la pile : les refaire depuis les tuiles du fond
+    _compositeCache.clear();
     _tiles.clear();
-    _tilePositions.clear();
+    _backbuffer.invalidate();
+    _tileRange = QRect();
+    loadTiles();
+    update();
+}
 
-    // Obtenir les données du modèle
-    QPointF center = _mapModel->getCenter();
-    int zoom = _mapModel->getZoom();
+bool MapWidget::openTileArchive(const QString& path)
+{
+    // L'archive est ouverte par le moteur de la source courante, partagé avec les autres vues,
+    // et rouverte par ses moteurs suivants si la vue change de source puis y revient
+    if (!_engine->openArchive(path))
+        return false;
+
+    // Les tuiles manquantes peuvent maintenant venir de l'archive
+    _tileRange = QRect();
+    loadTiles();
+    update();
+    return true;
+}
+
+bool MapWidget::storeTile(const TileKey& key, const QImage& tile)
+{
+    _compositeCache.remove(key);
+
+    // La tuile peut arriver après un déplacement : ne l'afficher que si elle est encore visible
+    if (!isTileWanted(key))
+        return false;
+
+    _tiles.insert(key, composedTile(key, tile));
+    return true;
+}
+
+QPixmap MapWidget::composedTile(const TileKey& key, const QImage& base)
+{
+    // La tuile compacte du cache n'est convertie au format d'affichage qu'en entrant dans la zone courante
+    if (_overlays.isEmpty())
+        return QPixmap::fromImage(base);
+
+    QImage cached = _compositeCache.find(key);
+    if (!cached.isNull())
+        return QPixmap::fromImage(cached);
+
+    // Composition faite une seule fois par tuile : le glissement ne fait que recopier le résultat
+    QImage image = base.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    for (const TileLayer* layer : qAsConst(_overlays))
+        TileCompositor::blend(image, layer->find(key), layer->opacity());
+
+    _compositeCache.insert(key, image);
+    return QPixmap::fromImage(image);
+}
+
+bool MapWidget::isTileWanted(const TileKey& key) const
+{
+    return key.zoom == _tileZoom && _tileRange.contains(key.x, key.y);
+}
 
-    // Calculer la tuile centrale avec des coordonnées fractionnaires
-    QPointF centralTileF = lonLatToTileF(center.x(), center.y(), zoom);
+void MapWidget::onTileMissing(const TileKey& key)
+{
+    // Un remplacement introuvable sur le disque pourra être recherché à nouveau
+    _fallbackKeys.remove(key);
+}
+
+void MapWidget::onTileReady(const TileKey& key, const QImage& tile)
+{
+    // Si la tuile est visible, la dessiner dans la vue ; le moteur l'a déjà mise en cache
+    if (storeTile(key, tile))
+        compositeTile(key, _tiles.value(key));
+    else if (_fallbackKeys.remove(key))
+        refreshPlaceholders(key);
+}
+
+void MapWidget::onTileFailed(const TileKey& key, const QString& errorMessage)
+{
+    qDebug() << "Erreur de téléchargement de tuile:" << errorMessage;
+
+    // Sans remplacement disponible, marquer la tuile manquante plutôt que de laisser le fond :
+    // le téléchargeur ne la redemandera qu'après son délai de relance
+    if (!isTileWanted(key))
+        return;
+
+    QRect tileRect = tileWorldRect(key);
+    if (!drawPlaceholder(key, tileRect))
+        _backbuffer.draw(key.zoom, tileRect, missingTile(), tileRect);
+    updateWorldRect(tileRect);
+}
+
+void MapWidget::onOverlayTileReady(const TileKey& key)
+{
+    _compositeCache.remove(key);
+    if (!isTileWanted(key))
+        return;
+
+    // Sans tuile du fond, la composition se fera à son arrivée
+    QImage base = _engine->find(key);
+    if (base.isNull())
+        return;
+
+    QPixmap tile = composedTile(key, base);
+    _tiles.insert(key, tile);
+    compositeTile(key, tile);
+}
+
+void MapWidget::loadTiles()
+{
+    int zoom = tileZoom();
+
+    // Calculer la tuile centrale de la vue (glissement compris) avec des coordonnées fractionnaires
+    QPointF centralTileF = viewCenterTile();
 
     // Obtenir la partie entière de la position centrale
     int centralTileX = floor(centralTileF.x());
     int centralTileY = floor(centralTileF.y());
+    _loadedCenterTile = QPoint(centralTileX, centralTileY);
 
     // Déterminer combien de tuiles sont nécessaires en fonction de la taille du widget
-    int tileSize = 256;
+    // (une tuile occupe sa taille en pixels logiques multipliée par l'échelle d'affichage)
+    double tileSize = screenTileSize();
 
-    // Facteur pour l'image mise en cache plus grande
-    int factor = 4; // Même facteur que dans renderFullView
+    // Zone de préchargement autour de la vue : le chargement suit le glissement,
+    // une demi-vue de chaque côté suffit
+    int factor = 2;
 
-    // Calculer le nombre de tuiles nécessaires pour couvrir l'image mise en cache
-    int tilesX = (width() * factor / tileSize) + 3; // +3 pour couvrir les bords et le décalage fractionnaire
-    int tilesY = (height() * factor / tileSize) + 3;
+    // Calculer le nombre de tuiles nécessaires pour couvrir la zone de préchargement
+    int tilesX = static_cast<int>(width() * factor / tileSize) + 3; // +3 pour couvrir les bords et le décalage fractionnaire
+    int tilesY = static_cast<int>(height() * factor / tileSize) + 3;
 
     // S'assurer qu'on a au moins un minimum de tuiles
     tilesX = qMax(5, tilesX);
@@ -252,83 +417,425 @@ void MapWidget::loadTiles()
     endX = qBound(0, endX, maxTile);
     endY = qBound(0, endY, maxTile);
 
-    // Télécharger ou charger les tuiles
+    // Rien de nouveau à charger si la zone n'a pas changé (zoom continu dans un même niveau)
+    QRect range(QPoint(startX, startY), QPoint(endX, endY));
+    if (range == _tileRange && zoom == _tileZoom)
+        return;
+
+    // Mémoriser la zone courante avant de charger pour que storeTile() la connaisse
+    _tileRange = range;
+    _tileZoom = zoom;
+
+    // Abandonner les téléchargements des tuiles sorties de la zone (si aucune autre vue ne les
+    // couvre) et ordonner les téléchargements depuis le centre de la vue, zone visible d'abord
+    QSizeF visibleTiles(width() / tileSize, height() / tileSize);
+    QRectF visibleRect(centralTileF - QPointF(visibleTiles.width() / 2, visibleTiles.height() / 2), visibleTiles);
+    _engine->setViewport(_client, zoom, _tileRange, centralTileF, visibleRect);
+    for (TileLayer* layer : qAsConst(_overlays))
+        layer->setViewport(zoom, _tileRange, centralTileF, visibleRect);
+
+    // Reprendre depuis le cache les tuiles déjà décodées, télécharger ou charger les autres
+    QHash<TileKey, QPixmap> previousTiles;
+    previousTiles.swap(_tiles);
+    _tiles.reserve(_tileRange.width() * _tileRange.height());
+
     for (int y = startY; y <= endY; y++) {
         for (int x = startX; x <= endX; x++) {
-            downloadTile(x, y, zoom);
+            TileKey key { zoom, x, y };
+            QPixmap tile = previousTiles.value(key);
+            if (tile.isNull()) {
+                QImage base = _engine->find(key);
+                if (!base.isNull())
+                    tile = composedTile(key, base);
+            }
+
+            if (!tile.isNull()) {
+                _tiles.insert(key, tile);
+            } else {
+                _engine->load(key);
+                loadFallback(key);
+            }
+
+            for (TileLayer* layer : qAsConst(_overlays))
+                layer->request(key);
+        }
+    }
+
+    // Préparer la suite : direction du mouvement et niveaux de zoom voisins
+    prefetchTiles();
+}
+
+void MapWidget::prefetchTiles()
+{
+    if (_prefetchBudget == 0) {
+        _engine->setPrefetch(_client, QVector<TileKey>());
+        return;
+    }
+
+    int zoom = tileZoom();
+    QPointF centralTileF = viewCenterTile();
+    QVector<TileKey> candidates;
+
+    // 1. Zone que la vue atteindra bientôt, d'après la vitesse du mouvement en cours
+    //    (la carte se déplace à l'opposé de la souris)
+    QPointF velocity = _kinetic ? _velocity : (_isDragging ? dragVelocity() : QPointF());
+    if (!velocity.isNull()) {
+        QPointF aheadTile = centralTileF - velocity * kPrefetchLookahead / screenTileSize();
+        QRect ahead = visibleTileRange(zoom, aheadTile);
+        QVector<QPair<double, TileKey>> ranked;
+        for (int y = ahead.top(); y <= ahead.bottom(); y++) {
+            for (int x = ahead.left(); x <= ahead.right(); x++) {
+                if (_tileRange.contains(x, y))
+                    continue;
+                double dx = x + 0.5 - aheadTile.x();
+                double dy = y + 0.5 - aheadTile.y();
+                ranked.append(qMakePair(dx * dx + dy * dy, TileKey { zoom, x, y }));
+            }
+        }
+        std::sort(ranked.begin(), ranked.end(),
+            [](const QPair<double, TileKey>& a, const QPair<double, TileKey>& b) { return a.first < b.first; });
+        for (const QPair<double, TileKey>& entry : qAsConst(ranked))
+            candidates.append(entry.second);
+    }
+
+    // 2. Vue complète aux niveaux de zoom voisins, depuis le centre (le zoom conserve le centre)
+    for (int neighbour : { zoom - 1, zoom + 1 }) {
+        if (neighbour < _mapModel->getMinZoom() + _zoomOffset || neighbour > _mapModel->getMaxZoom() + _zoomOffset)
+            continue;
+
+        QPointF neighbourCenter = centralTileF * std::pow(2.0, neighbour - zoom);
+        QRect range = visibleTileRange(neighbour, neighbourCenter);
+        QVector<QPair<double, TileKey>> ranked;
+        for (int y = range.top(); y <= range.bottom(); y++) {
+            for (int x = range.left(); x <= range.right(); x++) {
+                double dx = x + 0.5 - neighbourCenter.x();
+                double dy = y + 0.5 - neighbourCenter.y();
+                ranked.append(qMakePair(dx * dx + dy * dy, TileKey { neighbour, x, y }));
+            }
+        }
+        std::sort(ranked.begin(), ranked.end(),
+            [](const QPair<double, TileKey>& a, const QPair<double, TileKey>& b) { return a.first < b.first; });
+        for (const QPair<double, TileKey>& entry : qAsConst(ranked))
+            candidates.append(entry.second);
+    }
+
+    // Confier au moteur, dans la limite du budget, les tuiles absentes du cache mémoire
+    QVector<TileKey> keys;
+    for (const TileKey& key : qAsConst(candidates)) {
+        if (keys.size() == _prefetchBudget)
+            break;
+        if (!_engine->contains(key))
+            keys.append(key);
+    }
+    _engine->setPrefetch(_client, keys);
+}
+
+QRect MapWidget::visibleTileRange(int zoom, const QPointF& centerTile) const
+{
+    // Taille d'une tuile à l'écran, à l'échelle d'affichage courante
+    const double tileSize = screenTileSize();
+
+    double halfWidth = width() / tileSize / 2;
+    double halfHeight = height() / tileSize / 2;
+
+    int maxTile = (1 << zoom) - 1;
+    int startX = qBound(0, static_cast<int>(floor(centerTile.x() - halfWidth)), maxTile);
+    int startY = qBound(0, static_cast<int>(floor(centerTile.y() - halfHeight)), maxTile);
+    int endX = qBound(0, static_cast<int>(floor(centerTile.x() + halfWidth)), maxTile);
+    int endY = qBound(0, static_cast<int>(floor(centerTile.y() + halfHeight)), maxTile);
+
+    return QRect(QPoint(startX, startY), QPoint(endX, endY));
+}
+
+void MapWidget::compositeTile(const TileKey& key, const QPixmap& tile)
+{
+    // Dessiner la tuile dans le tampon (ignoré s'il couvre encore un autre zoom)
+    QRect tileRect = tileWorldRect(key);
+    _backbuffer.draw(key.zoom, tileRect, tile, tileRect);
+
+    // Ne rafraîchir que la partie de l'écran couverte par la tuile
+    updateWorldRect(tileRect);
+}
+
+bool MapWidget::drawPlaceholder(const TileKey& key, const QRect& clip)
+{
+    QRect target = tileWorldRect(key);
+    bool drawn = false;
+
+    // Ancêtre le plus proche en mémoire : la partie correspondant à la tuile est agrandie
+    for (int depth = 1; depth <= kMaxFallbackDepth && key.zoom - depth >= 0; depth++) {
+        TileKey parent { key.zoom - depth, key.x >> depth, key.y >> depth };
+        QImage image = _compositeCache.find(parent);
+        if (image.isNull())
+            image = _engine->find(parent);
+        if (image.isNull())
+            continue;
+
+        // Tuile compacte convertie seulement le temps du dessin
+        QPixmap tile = QPixmap::fromImage(image);
+
+        double size = tile.width() / static_cast<double>(1 << depth);
+        QRectF source((key.x - (parent.x << depth)) * size, (key.y - (parent.y << depth)) * size, size, size);
+        _backbuffer.draw(key.zoom, target, tile, source, clip);
+        drawn = true;
+        break;
+    }
+
+    // Tuiles enfants en mémoire, réduites de moitié, par-dessus l'ancêtre (plus nettes)
+    for (int i = 0; i < 4; i++) {
+        TileKey child { key.zoom + 1, key.x * 2 + (i & 1), key.y * 2 + (i >> 1) };
+        QImage image = _compositeCache.find(child);
+        if (image.isNull())
+            image = _engine->find(child);
+        if (image.isNull())
+            continue;
+
+        QPixmap tile = QPixmap::fromImage(image);
+
+        QRect quarter(target.x() + (i & 1) * target.width() / 2, target.y() + (i >> 1) * target.height() / 2,
+            target.width() / 2, target.height() / 2);
+        _backbuffer.draw(key.zoom, quarter, tile, QRectF(tile.rect()), clip);
+        drawn = true;
+    }
+
+    return drawn;
+}
+
+const QPixmap& MapWidget::missingTile()
+{
+    // Taille des tuiles de la source courante
+    const int tileSize = _tilePixels;
+
+    // Motif dessiné une seule fois par taille de tuile : fond uni rayé en diagonale
+    if (_missingTile.width() != tileSize) {
+        _missingTile = QPixmap(tileSize, tileSize);
+        _missingTile.fill(QColor(240, 240, 240));
+
+        QPainter painter(&_missingTile);
+        painter.setPen(QPen(QColor(225, 225, 225), 2));
+        for (int offset = -tileSize; offset < tileSize; offset += 16)
+            painter.drawLine(offset, tileSize, offset + tileSize, 0);
+    }
+    return _missingTile;
+}
+
+void MapWidget::refreshPlaceholders(const TileKey& parent)
+{
+    int depth = _tileZoom - parent.zoom;
+    if (depth <= 0 || depth > kMaxFallbackDepth)
+        return;
+
+    // Tuiles de la zone courante couvertes par la tuile parente
+    QRect covered(parent.x << depth, parent.y << depth, 1 << depth, 1 << depth);
+    covered = covered.intersected(_tileRange);
+
+    for (int y = covered.top(); y <= covered.bottom(); y++) {
+        for (int x = covered.left(); x <= covered.right(); x++) {
+            TileKey key { _tileZoom, x, y };
+            if (_tiles.contains(key))
+                continue;
+
+            QRect tileRect = tileWorldRect(key);
+            if (drawPlaceholder(key, tileRect))
+                updateWorldRect(tileRect);
         }
     }
 }
 
-void MapWidget::renderFullView()
+void MapWidget::updateWorldRect(const QRect& worldRect)
 {
-    // Créer une image plus grande que la taille du widget
-    int factor = 4; // Facteur 2 dans chaque dimension = 4 fois la surface totale
-    QSize cacheSize(width() * factor, height() * factor);
+    // Pixels du monde vers pixels logiques de l'écran
+    double scale = viewScale() / _pixelRatio;
+    QPointF topLeft = (QPointF(worldRect.topLeft()) - viewWorldOrigin()) * scale;
+    QRect screenRect = QRectF(topLeft, QSizeF(worldRect.size()) * scale).toAlignedRect().intersected(rect());
+    if (!screenRect.isEmpty())
+        update(screenRect);
+}
 
-    _cachedView = QPixmap(cacheSize);
-    _cachedView.fill(QColor(240, 240, 240));
+QRect MapWidget::tileWorldRect(const TileKey& key) const
+{
+    // Taille des tuiles de la source courante
+    const int tileSize = _tilePixels;
 
-    QPainter painter(&_cachedView);
-    painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+    return QRect(key.x * tileSize, key.y * tileSize, tileSize, tileSize);
+}
 
+QPointF MapWidget::viewCenterTile()
+{
     // Obtenir les données du modèle
     QPointF center = _mapModel->getCenter();
-    int zoom = _mapModel->getZoom();
+    int zoom = tileZoom();
 
-    // Calculer la tuile centrale avec des coordonnées fractionnaires
-    QPointF centralTileF = lonLatToTileF(center.x(), center.y(), zoom);
+    // Pendant le glissement et l'inertie, la vue est décalée sans que le modèle ne change
+    // (le décalage est en pixels de l'écran, à l'échelle d'affichage)
+    return Projection::lonLatToTile(center.x(), center.y(), zoom) + QPointF(_dragOffset) / screenTileSize();
+}
 
-    // Taille standard d'une tuile
-    const int tileSize = 256;
+QRect MapWidget::viewWorldRect()
+{
+    // À l'échelle s, le widget affiche une zone du monde de sa taille divisée par s
+    QSizeF worldSize = QSizeF(size()) * _pixelRatio / viewScale();
+    return QRectF(viewWorldOrigin(), worldSize).toAlignedRect();
+}
 
-    // Calculer le décalage pour centrer la tuile centrale
-    // Centrer sur l'image élargie
-    int centerX = cacheSize.width() / 2;
-    int centerY = cacheSize.height() / 2;
+QPointF MapWidget::viewWorldOrigin()
+{
+    // Position du centre de la vue en pixels du monde
+    QPointF centralTileF = viewCenterTile();
+
+    if (!isViewScaled()) {
+        QPoint centerPixel(qRound(centralTileF.x() * _tilePixels), qRound(centralTileF.y() * _tilePixels));
+        return QPointF(centerPixel - QPoint(width() * _pixelRatio / 2, height() * _pixelRatio / 2));
+    }
+
+    double scale = viewScale();
+    return centralTileF * _tilePixels - QPointF(width() / 2.0, height() / 2.0) * _pixelRatio / scale;
+}
 
-    // Dessiner toutes les tuiles
-    for (int i = 0; i < _tiles.size(); i++) {
-        QPoint tilePos = _tilePositions[i];
-        QPixmap tile = _tiles[i];
+double MapWidget::viewScale() const
+{
+    return std::pow(2.0, _mapModel->getZoom() - _mapModel->getTileZoom());
+}
 
-        int x = centerX + (tilePos.x() - centralTileF.x()) * tileSize;
-        int y = centerY + (tilePos.y() - centralTileF.y()) * tileSize;
+int MapWidget::tileZoom() const
+{
+    return _mapModel->getTileZoom() + _zoomOffset;
+}
+
+double MapWidget::screenTileSize() const
+{
+    return _tilePixels * viewScale() / _pixelRatio;
+}
+
+QSize MapWidget::backbufferSize() const
+{
+    // En pixels physiques : la mémoire du tampon suit la densité réelle de l'écran
+    return QSize(qCeil(width() * _pixelRatio * M_SQRT2), qCeil(height() * _pixelRatio * M_SQRT2));
+}
 
-        QRect tileRect(x, y, tileSize, tileSize);
-        painter.drawPixmap(tileRect, tile);
+bool MapWidget::isViewScaled() const
+{
+    return std::abs(viewScale() - 1.0) > 1e-9;
+}
+
+void MapWidget::updateBackbuffer()
+{
+    // Taille des tuiles de la source courante
+    const int tileSize = _tilePixels;
+
+    int zoom = tileZoom();
+    const QVector<QRect> exposed = _backbuffer.scrollTo(zoom, viewWorldRect());
+
+    // Redessiner les bandes exposées à partir des tuiles déjà décodées
+    int maxTile = (1 << zoom) - 1;
+    for (const QRect& area : exposed) {
+        int startX = static_cast<int>(floor(area.left() / static_cast<double>(tileSize)));
+        int startY = static_cast<int>(floor(area.top() / static_cast<double>(tileSize)));
+        int endX = static_cast<int>(floor(area.right() / static_cast<double>(tileSize)));
+        int endY = static_cast<int>(floor(area.bottom() / static_cast<double>(tileSize)));
+
+        // Hors du monde, il n'y a que le fond
+        startX = qMax(0, startX);
+        startY = qMax(0, startY);
+        endX = qMin(maxTile, endX);
+        endY = qMin(maxTile, endY);
+
+        for (int y = startY; y <= endY; y++) {
+            for (int x = startX; x <= endX; x++) {
+                TileKey key { zoom, x, y };
+                QPixmap tile = _tiles.value(key);
+                if (!tile.isNull()) {
+                    _backbuffer.draw(zoom, tileWorldRect(key), tile, area);
+                    continue;
+                }
+
+                // Tuile absente : remplacement provisoire depuis le cache mémoire (la tuile
+                // parente a été demandée au disque par loadTiles())
+                if (drawPlaceholder(key, area))
+                    continue;
+
+                // Tuile en échec : motif de tuile manquante, sans nouvelle requête
+                if (_engine->isBackingOff(key))
+                    _backbuffer.draw(zoom, tileWorldRect(key), missingTile(), area);
+            }
+        }
     }
+}
+
+void MapWidget::loadFallback(const TileKey& key)
+{
+    if (key.zoom == 0 || _engine->isBackingOff(key))
+        return;
+
+    // Lecture de la tuile parente sur le disque (jamais sur le réseau), sauf si elle est déjà en mémoire
+    TileKey parent { key.zoom - 1, key.x >> 1, key.y >> 1 };
+    if (_fallbackKeys.contains(parent) || _engine->contains(parent))
+        return;
 
-    _needFullRefresh = false;
+    // Une tuile parente déjà en route servira aussi de remplacement à son arrivée
+    if (_engine->loadLocal(parent))
+        _fallbackKeys.insert(parent);
 }
 
 void MapWidget::paintEvent(QPaintEvent* event)
 {
-    Q_UNUSED(event);
-
     QPainter painter(this);
 
-    if (_needFullRefresh) {
-        renderFullView();
-    }
+    // Faire défiler le tampon si la vue en sort et compléter les bandes exposées
+    updateBackbuffer();
 
-    if (_isDragging) {
-        // Pendant le glissement, dessiner l'image mise en cache avec un décalage
-        // Calculer l'offset pour centrer l'image
-        int factor = 4; // Même facteur que dans renderFullView
-        int offsetX = (width() * factor - width()) / 2;
-        int offsetY = (height() * factor - height()) / 2;
-
-        // Dessiner la partie appropriée de l'image mise en cache
-        painter.drawPixmap(-_dragOffset.x() - offsetX, -_dragOffset.y() - offsetY, _cachedView);
+    // Dessiner uniquement la zone à rafraîchir, prise dans le tampon (en pixels physiques)
+    QRect target = event->rect();
+    QRect deviceTarget(target.topLeft() * _pixelRatio, target.size() * _pixelRatio);
+    if (!isViewScaled()) {
+        _backbuffer.paint(painter, target.topLeft(), deviceTarget.translated(viewWorldOrigin().toPoint()), _pixelRatio);
     } else {
-        // En mode normal, dessiner la partie centrale de l'image mise en cache
-        int factor = 4; // Même facteur que dans renderFullView
-        int offsetX = (width() * factor - width()) / 2;
-        int offsetY = (height() * factor - height()) / 2;
+        // Zoom fractionnaire : rééchantillonner le tampon à l'échelle de l'écran, sans passer par le GPU
+        QSize deviceSize = size() * _pixelRatio;
+        if (_scaledFrame.size() != deviceSize)
+            _scaledFrame = QImage(deviceSize, QImage::Format_ARGB32_Premultiplied);
+        _backbuffer.paintScaled(_scaledFrame, viewWorldOrigin(), viewScale(), deviceTarget);
+        if (_pixelRatio == 1)
+            painter.drawImage(target.topLeft(), _scaledFrame, target);
+        else
+            painter.drawImage(QRectF(target), _scaledFrame, QRectF(deviceTarget));
+    }
+
+    // Les marqueurs sont dessinés par-dessus les tuiles, hors du tampon de rendu
+    drawMarkers(painter, target);
+}
 
-        painter.drawPixmap(0, 0, width(), height(), _cachedView,
-            offsetX, offsetY, width(), height());
+void MapWidget::drawMarkers(QPainter& painter, const QRect& target)
+{
+    if (_markerLayers.isEmpty())
+        return;
+
+    // Passage de l'écran (pixels logiques) au monde normalisé, via les pixels du monde au niveau des tuiles
+    QPointF origin = viewWorldOrigin();
+    double toScreen = viewScale() / _pixelRatio;
+    double worldPixels = double(1 << tileZoom()) * _tilePixels;
+
+    // Seuls les marqueurs qui touchent la zone redessinée sont recherchés
+    QRectF screenArea = QRectF(target).adjusted(-kMarkerMargin, -kMarkerMargin, kMarkerMargin, kMarkerMargin);
+    QRectF area((origin + screenArea.topLeft() / toScreen) / worldPixels,
+        (origin + screenArea.bottomRight() / toScreen) / worldPixels);
+
+    QVector<QPainter::PixmapFragment> fragments;
+    for (MarkerLayer* layer : qAsConst(_markerLayers)) {
+        QVector<MarkerCluster> clusters = layer->clusters(_mapModel->getTileZoom(), _mapModel->getMaxZoom(), area);
+        if (clusters.isEmpty())
+            continue;
+
+        MarkerAtlas& atlas = _markerAtlases[layer->color().rgba()];
+        if (atlas.isNull())
+            atlas = MarkerAtlas(layer->color(), _pixelRatio);
+
+        // Un seul appel de dessin par calque, par copies de fragments de l'atlas
+        fragments.clear();
+        fragments.reserve(clusters.size());
+        for (const MarkerCluster& cluster : qAsConst(clusters))
+            fragments.append(atlas.fragment((cluster.position * worldPixels - origin) * toScreen, cluster.count));
+        painter.drawPixmapFragments(fragments.constData(), fragments.size(), atlas.pixmap());
     }
 }
 
@@ -336,40 +843,162 @@ void MapWidget::resizeEvent(QResizeEvent* event)
 {
     QWidget::resizeEvent(event);
 
-    _needFullRefresh = true;
-    loadTiles();
+    // Le tampon de rendu suit la taille de la vue (plus une marge), agrandie de √2 pour
+    // couvrir la zone affichée à la plus petite échelle du zoom continu
+    _backbuffer.resize(backbufferSize());
+    if (!updatePixelRatio())
+        loadTiles();
+
+    emit viewSizeChanged(size());
+}
+
+void MapWidget::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+
+    // La fenêtre n'existe qu'au premier affichage : suivre alors ses changements d'écran,
+    // pour ajuster la résolution des tuiles hors du dessin
+    QWindow* windowHandle = window()->windowHandle();
+    if (!_screenConnection && windowHandle)
+        _screenConnection = connect(windowHandle, &QWindow::screenChanged, this, [this]() { updatePixelRatio(); });
+    updatePixelRatio();
+}
+
+void MapWidget::startFrameLoop()
+{
+    if (_frameTimer.isActive())
+        return;
+
+    // Cadencer la boucle sur la fréquence de rafraîchissement de l'écran
+    qreal refreshRate = screen() ? screen()->refreshRate() : 60.0;
+    _frameTimer.start(qMax(1, qRound(1000.0 / qMax<qreal>(1.0, refreshRate))));
+    _lastFrameTime = _frameClock.elapsed();
+}
+
+void MapWidget::onFrame()
+{
+    qint64 now = _frameClock.elapsed();
+    double dt = (now - _lastFrameTime) / 1000.0;
+    _lastFrameTime = now;
+
+    QPoint step;
+    if (_isDragging) {
+        // Appliquer en une fois tous les mouvements de souris reçus depuis la dernière image
+        step = _pendingDrag;
+        _pendingDrag = QPoint(0, 0);
+    } else if (_kinetic) {
+        // Défilement inertiel avec décélération exponentielle
+        _kineticRemainder += _velocity * dt;
+        step = _kineticRemainder.toPoint();
+        _kineticRemainder -= step;
+        _velocity *= std::exp(-dt / kFrictionTime);
+    }
+
+    if (!step.isNull()) {
+        _dragOffset -= step;
+
+        // Recharger la zone dès que le centre de la vue change de tuile : les tuiles
+        // qui vont entrer dans la vue sont demandées pendant le mouvement
+        QPointF centralTileF = viewCenterTile();
+        if (QPoint(floor(centralTileF.x()), floor(centralTileF.y())) != _loadedCenterTile)
+            loadTiles();
+
+        // Un seul dessin (et défilement du tampon) par image
+        update();
+    }
+
+    // Fin de l'inertie : reporter le déplacement dans le modèle
+    if (_kinetic && std::hypot(_velocity.x(), _velocity.y()) < kStopSpeed)
+        commitPan();
+
+    // Le zoom passe par le modèle, dont les signaux rechargent et redessinent la vue
+    if (_zooming)
+        stepZoom(dt);
+
+    // La boucle s'arrête dès qu'il n'y a plus rien à animer ; un mouvement de souris la relance
+    if (!_kinetic && !_zooming && step.isNull())
+        _frameTimer.stop();
+}
+
+void MapWidget::stepZoom(double dt)
+{
+    // Rapprochement exponentiel du zoom visé, indépendant de la cadence des images
+    double zoom = _mapModel->getZoom();
+    double next = _zoomTarget + (zoom - _zoomTarget) * std::exp(-dt / kZoomTime);
+    if (std::abs(next - _zoomTarget) < 0.002) {
+        next = _zoomTarget;
+        _zooming = false;
+    }
+
+    // Garder le point sous le curseur immobile à l'écran
+    QPointF offset = _zoomAnchor - QPointF(width() / 2.0, height() / 2.0);
+    _mapController->zoomAround(next, _zoomAnchorLonLat.x(), _zoomAnchorLonLat.y(), offset.x(), offset.y());
+}
+
+void MapWidget::commitPan()
+{
+    _kinetic = false;
+    _velocity = QPointF();
+    _kineticRemainder = QPointF();
+
+    if (_dragOffset.isNull())
+        return;
+
+    // Remettre le décalage à zéro avant la mise à jour du modèle, qui recharge la vue
+    QPoint offset = _dragOffset;
+    _dragOffset = QPoint(0, 0);
+    _mapController->panMap(offset.x(), offset.y(), _mapModel->getZoom());
+}
+
+QPointF MapWidget::dragVelocity() const
+{
+    if (_dragSamples.size() < 2)
+        return QPointF();
+
+    // Pas d'inertie si la souris était immobile juste avant le relâchement
+    const QPair<qint64, QPoint>& last = _dragSamples.last();
+    if (_frameClock.elapsed() - last.first > kVelocityWindow / 2)
+        return QPointF();
+
+    const QPair<qint64, QPoint>& first = _dragSamples.first();
+    qint64 elapsed = last.first - first.first;
+    if (elapsed <= 0)
+        return QPointF();
+
+    QPointF velocity = QPointF(last.second - first.second) * (1000.0 / elapsed);
+    double speed = std::hypot(velocity.x(), velocity.y());
+    return speed > kMaxSpeed ? velocity * (kMaxSpeed / speed) : velocity;
 }
 
 void MapWidget::mousePressEvent(QMouseEvent* event)
 {
     if (event->button() == Qt::LeftButton) {
+        // Saisir la carte arrête l'inertie et le zoom animé ; le décalage restant est conservé
+        _kinetic = false;
+        _zooming = false;
         _isDragging = true;
         _lastMousePos = event->pos();
-        _dragOffset = QPoint(0, 0);
+        _pendingDrag = QPoint(0, 0);
+        _dragSamples.clear();
+        _dragSamples.append(qMakePair(_frameClock.elapsed(), event->pos()));
         setCursor(Qt::ClosedHandCursor);
-
-        // S'assurer que la vue est à jour avant de commencer le glissement
-        if (_needFullRefresh) {
-            renderFullView();
-            update();
-        }
     }
 }
 
 void MapWidget::mouseMoveEvent(QMouseEvent* event)
 {
     if (_isDragging) {
-        // Calculer le déplacement en pixels
-        QPoint delta = event->pos() - _lastMousePos;
-
-        // Mettre à jour le décalage total
-        _dragOffset -= delta;
-
-        // Mettre à jour la dernière position
+        // Accumuler le déplacement : il sera appliqué à la prochaine image
+        _pendingDrag += event->pos() - _lastMousePos;
         _lastMousePos = event->pos();
 
-        // Forcer un rafraîchissement immédiat
-        update();
+        // Conserver les positions récentes pour estimer la vitesse au relâchement
+        qint64 now = _frameClock.elapsed();
+        _dragSamples.append(qMakePair(now, event->pos()));
+        while (_dragSamples.size() > 2 && now - _dragSamples.first().first > kVelocityWindow)
+            _dragSamples.removeFirst();
+
+        startFrameLoop();
     }
     // Émettre le signal avec les coordonnées géographiques sous le curseur
     QPair<double, double> coords = screenToLonLat(event->pos());
@@ -382,33 +1011,64 @@ void MapWidget::mouseReleaseEvent(QMouseEvent* event)
         _isDragging = false;
         setCursor(Qt::ArrowCursor);
 
-        // Utiliser le contrôleur pour mettre à jour le modèle
-        _mapController->panMap(_dragOffset.x(), _dragOffset.y(), _mapModel->getZoom());
-
-        // Réinitialiser le décalage
-        _dragOffset = QPoint(0, 0);
+        // Appliquer le dernier déplacement non encore affiché
+        _dragOffset -= _pendingDrag;
+        _pendingDrag = QPoint(0, 0);
+
+        // Lancer le défilement inertiel si la souris allait assez vite
+        _velocity = dragVelocity();
+        if (std::hypot(_velocity.x(), _velocity.y()) >= kMinKineticSpeed) {
+            _kinetic = true;
+            _kineticRemainder = QPointF();
+            startFrameLoop();
+        } else {
+            // Utiliser le contrôleur pour mettre à jour le modèle
+            commitPan();
+        }
     }
 }
 
 void MapWidget::wheelEvent(QWheelEvent* event)
 {
-    // Utiliser le contrôleur pour gérer le zoom
-    _mapController->zoomMap(event->angleDelta().y());
+    // Le zoom part de la vue affichée : reporter d'abord le déplacement en cours
+    _dragOffset -= _pendingDrag;
+    _pendingDrag = QPoint(0, 0);
+    commitPan();
+
+    // Cumuler les crans dans le zoom visé : les pavés tactiles donnent des fractions de cran
+    if (!_zooming)
+        _zoomTarget = _mapModel->getZoom();
+    double notches = event->angleDelta().y() / 120.0;
+    _zoomTarget = qBound<double>(_mapModel->getMinZoom(), _zoomTarget + notches * kZoomPerNotch,
+        _mapModel->getMaxZoom());
+
+    // Le point sous le curseur reste fixe pendant toute l'animation
+    _zoomAnchor = event->position();
+    QPair<double, double> anchor = screenToLonLat(event->position().toPoint());
+    _zoomAnchorLonLat = QPointF(anchor.first, anchor.second);
+
+    _zooming = true;
+    startFrameLoop();
 }
 
 void MapWidget::mouseDoubleClickEvent(QMouseEvent* event)
 {
     if (event->button() == Qt::LeftButton) {
+        // Reporter le déplacement en cours avant de recentrer
+        _isDragging = false;
+        _zooming = false;
+        _dragOffset -= _pendingDrag;
+        _pendingDrag = QPoint(0, 0);
+        commitPan();
+        setCursor(Qt::ArrowCursor);
+
         // Récupérer les coordonnées géographiques du point cliqué
         QPair<double, double> coords = screenToLonLat(event->pos());
         double lon = coords.first;
         double lat = coords.second;
 
-        // Centrer la carte sur ce point
-        _mapController->setCenter(lon, lat);
-
-        // Zoomer d'un niveau
-        int currentZoom = _mapModel->getZoom();
-        _mapController->setZoom(currentZoom + 1);
+        // Centrer la carte sur ce point et zoomer d'un niveau, en une seule mise à jour
+        double currentZoom = _mapModel->getZoom();
+        _mapController->zoomAround(currentZoom + 1, lon, lat, 0.0, 0.0);
     }
 }
@@ -4,12 +4,27 @@
 
 #include "controller/mapcontroller.h"
 #include "model/mapmodel.h"
-#include <QNetworkAccessManager>
+#include "model/markerlayer.h"
+#include "model/tilecache.h"
+#include "model/tileengine.h"
+#include "model/tilelayer.h"
+#include "view/markeratlas.h"
+#include "view/tilebackbuffer.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QImage>
+#include <QPair>
+#include <QRect>
+#include <QSet>
+#include <QSharedPointer>
+#include <QTimer>
+#include <QVector>
 #include <QWidget>
 
-class QNetworkReply;
+class QPainter;
 class QPaintEvent;
 class QResizeEvent;
+class QShowEvent;
 class QMouseEvent;
 class QWheelEvent;
 
@@ -19,6 +34,17 @@ class QWheelEvent;
  *
  * Cette classe gère le téléchargement et l'affichage d'une carte composée de
  * tuiles cartographiques OpenStreetMap.
+ *
+ * Les tuiles sont obtenues auprès du moteur partagé de la source
+ * (TileEngine) : plusieurs vues de la même source partagent ainsi leurs
+ * caches, leurs connexions et leurs téléchargements.
+ *
+ * Des calques transparents (TileLayer) peuvent être superposés au fond de
+ * carte. Chaque tuile affichée est composée une fois, puis gardée en cache
+ * jusqu'à l'arrivée d'une nouvelle tuile du fond ou d'un calque.
+ *
+ * Des calques de marqueurs (MarkerLayer) sont dessinés par-dessus les
+ * tuiles, regroupés selon le zoom, à partir d'un atlas de symboles.
  */
 class MapWidget : public QWidget {
     Q_OBJECT
@@ -27,15 +53,41 @@ private:
     MapModel* _mapModel; ///< Modèle de données pour la carte
     MapController* _mapController; ///< Contrôleur pour les interactions avec la carte
 
-    QVector<QPixmap> _tiles; ///< Tuiles à afficher
-    QVector<QPoint> _tilePositions; ///< Positions des tuiles sur la carte
-    QNetworkAccessManager _networkManager; ///< Gestionnaire de réseau pour télécharger les tuiles
-    int _pendingRequests; ///< Nombre de requêtes en attente
+    QHash<TileKey, QPixmap> _tiles; ///< Tuiles de la zone courante, converties au format d'affichage
+    TileCache _compositeCache; ///< Cache mémoire LRU des tuiles composées avec les calques
+    QVector<TileLayer*> _overlays; ///< Calques superposés au fond de carte, du bas vers le haut
+    QVector<MarkerLayer*> _markerLayers; ///< Calques de marqueurs dessinés par-dessus les tuiles, non possédés
+    QHash<QRgb, MarkerAtlas> _markerAtlases; ///< Atlas des symboles de marqueurs, par couleur
+    QRect _tileRange; ///< Plage de tuiles couverte par la vue courante
+    int _tileZoom; ///< Niveau de zoom de la plage de tuiles courante
+    QSet<TileKey> _fallbackKeys; ///< Tuiles parentes lues sur le disque pour servir de remplacement
+    int _prefetchBudget; ///< Nombre maximal de tuiles préchargées par chargement
+    QSharedPointer<TileEngine> _engine; ///< Moteur de tuiles partagé de la source affichée
+    int _client; ///< Identifiant de la vue auprès du moteur
+    TileSource _tileSource; ///< Source de tuiles choisie, avant adaptation à la densité de l'écran
+    int _pixelRatio; ///< Pixels du monde par pixel logique : 1, ou 2 sur un écran haute densité
+    int _zoomOffset; ///< Écart entre le niveau des tuiles chargées et celui du modèle (1 sans tuiles « @2x »)
+    int _tilePixels; ///< Taille des tuiles chargées, en pixels du monde
     QPoint _lastMousePos; ///< Dernière position de la souris pour le déplacement
     bool _isDragging; ///< Indique si la carte est en train d'être déplacée
-    QPixmap _cachedView; ///< Vue mise en cache pour le glissement rapide
-    QPoint _dragOffset; ///< Décalage actuel pendant le glissement
-    bool _needFullRefresh; ///< Indique si un fullRefresh est nécessaire
+    TileBackbuffer _backbuffer; ///< Tampon de rendu torique pour le glissement rapide
+    QPoint _dragOffset; ///< Décalage de la vue non encore reporté dans le modèle
+    QPoint _loadedCenterTile; ///< Tuile centrale de la vue lors du dernier chargement
+    QTimer _frameTimer; ///< Boucle d'animation cadencée sur le rafraîchissement de l'écran
+    QElapsedTimer _frameClock; ///< Horloge de la boucle d'animation et du suivi de vitesse
+    qint64 _lastFrameTime; ///< Instant de la dernière image, en millisecondes
+    QPoint _pendingDrag; ///< Déplacement de la souris accumulé depuis la dernière image
+    QVector<QPair<qint64, QPoint>> _dragSamples; ///< Positions récentes de la souris (instant, position)
+    QPointF _velocity; ///< Vitesse du défilement inertiel, en pixels par seconde
+    QPointF _kineticRemainder; ///< Fraction de pixel du défilement inertiel pas encore appliquée
+    bool _kinetic; ///< Indique si le défilement inertiel est en cours
+    bool _zooming; ///< Indique si une animation de zoom est en cours
+    double _zoomTarget; ///< Niveau de zoom visé par l'animation de zoom
+    QPointF _zoomAnchor; ///< Position à l'écran du point fixe de l'animation de zoom
+    QPointF _zoomAnchorLonLat; ///< Coordonnées géographiques du point fixe (longitude, latitude)
+    QImage _scaledFrame; ///< Image de la vue rééchantillonnée, utilisée quand l'échelle n'est pas 1
+    QPixmap _missingTile; ///< Motif affiché à la place d'une tuile en échec
+    QMetaObject::Connection _screenConnection; ///< Suivi des changements d'écran de la fenêtre, établi au premier affichage
 
 protected:
     /**
@@ -53,6 +105,11 @@ public:
      */
     MapWidget(MapModel* mapModel, MapController* mapController, QWidget* parent = nullptr);
 
+    /**
+     * @brief Destructeur : retire la vue du moteur de tuiles.
+     */
+    ~MapWidget() override;
+
     /**
      * @brief Convertit des coordonnées écran en coordonnées géographiques.
      * @param screenPos Position sur l'écran
@@ -60,6 +117,98 @@ public:
      */
     QPair<double, double> screenToLonLat(const QPoint& screenPos);
 
+    /**
+     * @brief Définit le budget mémoire du cache de tuiles décodées.
+     * @param maxBytes Budget mémoire en octets
+     */
+    void setTileCacheSize(qint64 maxBytes);
+
+    /**
+     * @brief Définit le budget mémoire du cache de données PNG.
+     * @param maxBytes Budget mémoire en octets
+     */
+    void setTileDataCacheSize(qint64 maxBytes);
+
+    /**
+     * @brief Définit le nombre maximal de tuiles préchargées à chaque chargement.
+     * @param budget Nombre de tuiles (0 désactive le préchargement)
+     */
+    void setPrefetchBudget(int budget);
+
+    /**
+     * @brief Ouvre une archive de tuiles pré-rendues, consultée avant le cache disque et le réseau.
+     *
+     * L'archive est ouverte par le moteur de la source courante et profite à
+     * toutes ses vues ; une seule archive peut être ouverte par moteur. Elle
+     * reste attachée à la source quand la vue en change puis y revient.
+     * @param path Chemin de l'archive
+     * @return Vrai si l'archive a été ouverte
+     */
+    bool openTileArchive(const QString& path);
+
+    /**
+     * @brief Définit le quota d'occupation du cache disque des tuiles de la source courante.
+     * @param maxBytes Quota en octets
+     */
+    void setDiskCacheSize(qint64 maxBytes);
+
+    /**
+     * @brief Change de serveur de tuiles.
+     *
+     * Les tuiles de l'ancienne source sont abandonnées et la vue est
+     * rechargée depuis le cache disque propre à la nouvelle source.
+     * @param source Nouvelle source de tuiles
+     */
+    void setTileSource(const TileSource& source);
+
+    /**
+     * @brief Récupère le moteur de tuiles de la source affichée.
+     * @return Moteur partagé, adapté à la densité de l'écran (variante « @2x » éventuelle)
+     */
+    QSharedPointer<TileEngine> tileEngine() const;
+
+    /**
+     * @brief Ajoute un calque au-dessus des calques existants.
+     * @param source Source des tuiles du calque
+     * @param opacity Opacité du calque, entre 0 et 1
+     * @return Position du calque dans la pile
+     */
+    int addOverlay(const TileSource& source, double opacity = 1.0);
+
+    /**
+     * @brief Retire un calque de la pile.
+     * @param index Position du calque
+     */
+    void removeOverlay(int index);
+
+    /**
+     * @brief Définit l'opacité d'un calque.
+     * @param index Position du calque
+     * @param opacity Opacité, entre 0 et 1
+     */
+    void setOverlayOpacity(int index, double opacity);
+
+    /**
+     * @brief Récupère le nombre de calques superposés au fond de carte.
+     * @return Nombre de calques
+     */
+    int overlayCount() const;
+
+    /**
+     * @brief Ajoute un calque de marqueurs au-dessus des tuiles.
+     *
+     * Le calque n'est pas possédé par le widget ; il est retiré
+     * automatiquement à sa destruction.
+     * @param layer Calque de marqueurs
+     */
+    void addMarkerLayer(MarkerLayer* layer);
+
+    /**
+     * @brief Retire un calque de marqueurs.
+     * @param layer Calque de marqueurs
+     */
+    void removeMarkerLayer(MarkerLayer* layer);
+
 signals:
     /**
      * @brief Signal émis lorsque la position de la souris change sur la carte.
@@ -68,6 +217,21 @@ signals:
      */
     void mousePositionChanged(double lon, double lat);
 
+    /**
+     * @brief Signal émis lorsque la taille de la vue change.
+     * @param size Nouvelle taille, en pixels logiques
+     */
+    void viewSizeChanged(const QSize& size);
+
+    /**
+     * @brief Signal émis lorsque la carte passe au moteur d'une autre source.
+     *
+     * Changement de source, ou passage à la variante « @2x » de la source
+     * quand la fenêtre change d'écran.
+     * @param engine Nouveau moteur de tuiles
+     */
+    void tileEngineChanged(const QSharedPointer<TileEngine>& engine);
+
 public slots:
     /**
      * @brief Slot appelé lorsque le centre de la carte change.
@@ -86,55 +250,209 @@ private:
     void loadTiles();
 
     /**
-     * @brief Prépare l'affichage complet de la carte.
+     * @brief Précharge les tuiles dans la direction du mouvement et aux niveaux de zoom voisins.
+     *
+     * Le préchargement est limité par le budget et passe après les tuiles visibles.
      */
-    void renderFullView();
+    void prefetchTiles();
 
     /**
-     * @brief Convertit des coordonnées géographiques en coordonnées de tuile.
-     * @param lon Longitude
-     * @param lat Latitude
+     * @brief Calcule la plage de tuiles couvrant la vue autour d'un centre donné.
      * @param zoom Niveau de zoom
-     * @return Coordonnées de la tuile (x, y)
+     * @param centerTile Centre de la vue en coordonnées de tuile à ce niveau
+     * @return Plage de tuiles, limitée aux tuiles valides
      */
-    QPoint lonLatToTile(double lon, double lat, int zoom);
+    QRect visibleTileRange(int zoom, const QPointF& centerTile) const;
 
     /**
-     * @brief Convertit des coordonnées géographiques en coordonnées de tuile (version flottante).
-     * @param lon Longitude
-     * @param lat Latitude
-     * @param zoom Niveau de zoom
-     * @return Coordonnées de la tuile (x, y) en flottant
+     * @brief Fait suivre la vue au tampon de rendu et dessine les bandes exposées.
+     *
+     * Le dessin ne part que des tuiles en mémoire : aucune tuile n'est demandée ici.
      */
-    QPointF lonLatToTileF(double lon, double lat, int zoom);
+    void updateBackbuffer();
 
     /**
-     * @brief Convertit des coordonnées de tuile en coordonnées géographiques.
-     * @param x Coordonnée X de la tuile
-     * @param y Coordonnée Y de la tuile
-     * @param zoom Niveau de zoom
-     * @return Coordonnées géographiques (longitude, latitude)
+     * @brief Demande au disque la tuile parente d'une tuile absente, pour servir de remplacement.
+     * @param key Identifiant de la tuile absente
      */
-    QPair<double, double> tileToLonLat(int x, int y, int zoom);
+    void loadFallback(const TileKey& key);
 
     /**
-     * @brief Télécharge une tuile depuis le serveur OpenStreetMap.
-     * @param x Coordonnée X de la tuile
-     * @param y Coordonnée Y de la tuile
-     * @param zoom Niveau de zoom
+     * @brief Démarre la boucle d'animation si elle ne tourne pas déjà.
      */
-    void downloadTile(int x, int y, int zoom);
+    void startFrameLoop();
 
     /**
-     * @brief Construit le chemin du fichier local pour une tuile.
-     * @param x Coordonnée X de la tuile
-     * @param y Coordonnée Y de la tuile
-     * @param zoom Niveau de zoom
-     * @return Chemin du fichier local
+     * @brief Avance l'animation de zoom d'une image.
+     * @param dt Temps écoulé depuis l'image précédente, en secondes
+     */
+    void stepZoom(double dt);
+
+    /**
+     * @brief Reporte dans le modèle le décalage de la vue et arrête le défilement inertiel.
+     */
+    void commitPan();
+
+    /**
+     * @brief Estime la vitesse de la souris à partir des positions récentes.
+     * @return Vitesse en pixels par seconde
+     */
+    QPointF dragVelocity() const;
+
+    /**
+     * @brief Dessine les marqueurs de tous les calques qui touchent une zone de l'écran.
+     * @param painter Peintre du widget
+     * @param target Zone à redessiner, en pixels logiques
+     */
+    void drawMarkers(QPainter& painter, const QRect& target);
+
+    /**
+     * @brief Dessine une tuile arrivée dans le tampon de rendu et ne rafraîchit que sa zone.
+     * @param key Identifiant de la tuile
+     * @param tile Tuile décodée
      */
-    QString tileFilePath(int x, int y, int zoom);
+    void compositeTile(const TileKey& key, const QPixmap& tile);
+
+    /**
+     * @brief Dessine un remplacement provisoire pour une tuile absente.
+     *
+     * Utilise l'ancêtre le plus proche présent en mémoire, agrandi, puis
+     * recouvre avec les tuiles enfants disponibles, réduites.
+     * @param key Identifiant de la tuile absente
+     * @param clip Zone du monde à laquelle limiter le dessin
+     * @return Vrai si un remplacement a été dessiné
+     */
+    bool drawPlaceholder(const TileKey& key, const QRect& clip);
+
+    /**
+     * @brief Récupère le motif affiché à la place d'une tuile dont le téléchargement a échoué.
+     * @return Motif de la taille d'une tuile, créé au premier appel
+     */
+    const QPixmap& missingTile();
+
+    /**
+     * @brief Redessine les remplacements des tuiles absentes couvertes par une tuile parente.
+     * @param parent Identifiant de la tuile parente arrivée
+     */
+    void refreshPlaceholders(const TileKey& parent);
+
+    /**
+     * @brief Demande le rafraîchissement de la partie de l'écran couverte par une zone du monde.
+     * @param worldRect Zone du monde au zoom courant
+     */
+    void updateWorldRect(const QRect& worldRect);
+
+    /**
+     * @brief Calcule l'emplacement d'une tuile dans le monde.
+     * @param key Identifiant de la tuile
+     * @return Rectangle de la tuile, en pixels du monde à son niveau de zoom
+     */
+    QRect tileWorldRect(const TileKey& key) const;
+
+    /**
+     * @brief Calcule la tuile centrale de la vue, glissement en cours compris.
+     * @return Coordonnées fractionnaires de la tuile au centre du widget
+     */
+    QPointF viewCenterTile();
+
+    /**
+     * @brief Calcule la zone du monde affichée par le widget.
+     * @return Zone affichée, en pixels du monde au niveau des tuiles, glissement compris
+     */
+    QRect viewWorldRect();
+
+    /**
+     * @brief Calcule le point du monde affiché au coin supérieur gauche du widget.
+     *
+     * À l'échelle 1, le point est arrondi au pixel pour que le tampon soit
+     * recopié sans rééchantillonnage.
+     * @return Point du monde, en pixels au niveau des tuiles
+     */
+    QPointF viewWorldOrigin();
+
+    /**
+     * @brief Calcule l'échelle d'affichage des tuiles pour le zoom courant.
+     * @return Pixels de l'écran par pixel de tuile, entre 1/√2 et √2
+     */
+    double viewScale() const;
+
+    /**
+     * @brief Indique si les tuiles sont affichées à une autre échelle que 1.
+     * @return Vrai pendant le zoom continu, sur un niveau fractionnaire
+     */
+    bool isViewScaled() const;
+
+    /**
+     * @brief Applique la source choisie en l'adaptant à la densité de l'écran.
+     *
+     * Sur un écran haute densité, la variante « @2x » de la source est
+     * utilisée si elle existe ; sinon les tuiles du niveau de zoom suivant
+     * sont affichées à demi-taille.
+     */
+    void applyTileSource();
+
+    /**
+     * @brief Met à jour le rapport de pixels d'après l'écran du widget.
+     * @return Vrai si le rapport a changé (la vue est alors rechargée)
+     */
+    bool updatePixelRatio();
+
+    /**
+     * @brief Récupère le niveau de zoom des tuiles chargées.
+     * @return Niveau de tuiles du modèle, plus un sans tuiles « @2x » sur un écran haute densité
+     */
+    int tileZoom() const;
+
+    /**
+     * @brief Calcule la taille d'une tuile chargée à l'écran, à l'échelle d'affichage courante.
+     * @return Taille en pixels logiques
+     */
+    double screenTileSize() const;
+
+    /**
+     * @brief Calcule la taille du tampon de rendu pour la taille courante de la vue.
+     * @return Taille en pixels physiques
+     */
+    QSize backbufferSize() const;
+
+    /**
+     * @brief Enregistre une tuile décodée dans la zone courante si elle est encore utile.
+     * @param key Identifiant de la tuile
+     * @param tile Tuile décodée
+     * @return Vrai si la tuile fait partie de la zone courante
+     */
+    bool storeTile(const TileKey& key, const QImage& tile);
+
+    /**
+     * @brief Compose une tuile du fond de carte avec les tuiles des calques.
+     *
+     * Le résultat est gardé en cache jusqu'à l'arrivée d'une nouvelle tuile
+     * de l'un des calques ou du fond.
+     * @param key Identifiant de la tuile
+     * @param base Tuile du fond de carte, dans son format compact
+     * @return Tuile à afficher, au format d'affichage
+     */
+    QPixmap composedTile(const TileKey& key, const QImage& base);
+
+    /**
+     * @brief Recompose toute la vue après une modification de la pile de calques.
+     */
+    void reloadOverlays();
+
+    /**
+     * @brief Indique si une tuile fait partie de la zone courante.
+     * @param key Identifiant de la tuile
+     * @return Vrai si la tuile est encore utile à la vue
+     */
+    bool isTileWanted(const TileKey& key) const;
 
 protected:
+    /**
+     * @brief Gère l'affichage du widget : suit les changements d'écran de sa fenêtre.
+     * @param event Événement d'affichage
+     */
+    void showEvent(QShowEvent* event) override;
+
     /**
      * @brief Gère l'événement de dessin du widget.
      * @param event Événement de dessin
@@ -173,10 +491,38 @@ protected:
 
 private slots:
     /**
-     * @brief Slot appelé lorsqu'une tuile a été téléchargée.
-     * @param reply Réponse du serveur contenant la tuile
+     * @brief Slot appelé à chaque image de la boucle d'animation.
+     *
+     * Applique le déplacement de souris accumulé ou le défilement inertiel
+     * et avance l'animation de zoom, puis demande un seul dessin pour l'image.
+     */
+    void onFrame();
+
+    /**
+     * @brief Slot appelé lorsque le moteur a décodé une tuile du fond de carte.
+     * @param key Identifiant de la tuile
+     * @param tile Tuile décodée, déjà en cache dans le moteur
+     */
+    void onTileReady(const TileKey& key, const QImage& tile);
+
+    /**
+     * @brief Slot appelé lorsqu'une tuile demandée en remplacement est absente du disque.
+     * @param key Identifiant de la tuile
+     */
+    void onTileMissing(const TileKey& key);
+
+    /**
+     * @brief Slot appelé lorsque le téléchargement d'une tuile a échoué.
+     * @param key Identifiant de la tuile
+     * @param errorMessage Message d'erreur
+     */
+    void onTileFailed(const TileKey& key, const QString& errorMessage);
+
+    /**
+     * @brief Slot appelé lorsqu'une tuile d'un calque vient d'être décodée.
+     * @param key Identifiant de la tuile
      */
-    void onTileDownloaded(QNetworkReply* reply);
+    void onOverlayTileReady(const TileKey& key);
 };
 
 #endif // MAPWIDGET_H
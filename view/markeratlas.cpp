@@ -0,0 +1,125 @@
+// markeratlas.cpp
+#include "markeratlas.h"
+
+#include <QFont>
+#include <QtMath>
+#include <algorithm>
+
+namespace {
+
+/// Nombre minimal de points de chaque symbole : un point isolé, puis les classes de regroupement
+const int kThresholds[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 20, 50, 100, 200, 500,
+    1000, 2000, 5000, 10000, 20000, 50000, 100000 };
+const int kGlyphCount = int(sizeof(kThresholds) / sizeof(kThresholds[0])); ///< Nombre de symboles de l'atlas
+const double kPointDiameter = 12.0; ///< Diamètre du symbole d'un point isolé, en pixels logiques
+const double kClusterDiameter = 22.0; ///< Diamètre du plus petit regroupement, en pixels logiques
+const double kPadding = 2.0; ///< Marge autour de chaque symbole, en pixels logiques
+
+/**
+ * @brief Calcule le diamètre d'un symbole.
+ * @param glyph Rang du symbole
+ * @return Diamètre en pixels logiques, croissant avec la classe de regroupement
+ */
+double diameterOf(int glyph)
+{
+    return glyph == 0 ? kPointDiameter : kClusterDiameter + glyph;
+}
+
+/**
+ * @brief Construit le libellé d'une classe de regroupement.
+ * @param glyph Rang du symbole
+ * @return Nombre exact sous 10, seuil arrondi au-delà (« 20+ », « 5k+ »)
+ */
+QString labelOf(int glyph)
+{
+    int threshold = kThresholds[glyph];
+    if (threshold < 10)
+        return QString::number(threshold);
+    if (threshold < 1000)
+        return QString::number(threshold) + "+";
+    return QString::number(threshold / 1000) + "k+";
+}
+
+} // namespace
+
+MarkerAtlas::MarkerAtlas()
+    : _pixelRatio(1.0)
+{
+}
+
+MarkerAtlas::MarkerAtlas(const QColor& color, qreal pixelRatio)
+    : _pixelRatio(pixelRatio)
+{
+    // Symboles côte à côte, chacun dans une case entière de pixels physiques
+    int width = 0;
+    int height = 0;
+    for (int glyph = 0; glyph < kGlyphCount; ++glyph) {
+        int side = qCeil((diameterOf(glyph) + 2 * kPadding) * pixelRatio);
+        _glyphs.append(QRect(width, 0, side, side));
+        width += side;
+        height = qMax(height, side);
+    }
+
+    _pixmap = QPixmap(width, height);
+    _pixmap.fill(Qt::transparent);
+
+    QPainter painter(&_pixmap);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+    painter.scale(pixelRatio, pixelRatio);
+
+    QFont font = painter.font();
+    font.setBold(true);
+
+    for (int glyph = 0; glyph < kGlyphCount; ++glyph) {
+        QRectF cell(QPointF(_glyphs[glyph].topLeft()) / pixelRatio, QSizeF(_glyphs[glyph].size()) / pixelRatio);
+        double diameter = diameterOf(glyph);
+        QRectF disc(cell.center() - QPointF(diameter, diameter) / 2.0, QSizeF(diameter, diameter));
+
+        if (glyph == 0) {
+            // Point isolé : pastille pleine cerclée de blanc
+            painter.setPen(QPen(Qt::white, 2.0));
+            painter.setBrush(color);
+            painter.drawEllipse(disc.adjusted(1.0, 1.0, -1.0, -1.0));
+            continue;
+        }
+
+        // Regroupement : halo translucide, disque plein et nombre de points
+        QColor halo = color;
+        halo.setAlpha(90);
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(halo);
+        painter.drawEllipse(disc);
+        painter.setBrush(color);
+        painter.drawEllipse(disc.adjusted(3.0, 3.0, -3.0, -3.0));
+
+        font.setPixelSize(qMax(8, qRound(diameter * 0.36)));
+        painter.setFont(font);
+        painter.setPen(Qt::white);
+        painter.drawText(disc, Qt::AlignCenter, labelOf(glyph));
+    }
+}
+
+bool MarkerAtlas::isNull() const
+{
+    return _pixmap.isNull();
+}
+
+const QPixmap& MarkerAtlas::pixmap() const
+{
+    return _pixmap;
+}
+
+QPainter::PixmapFragment MarkerAtlas::fragment(const QPointF& center, int count) const
+{
+    // Le fragment est copié à l'échelle logique : 1/ratio de sa taille en pixels physiques
+    return QPainter::PixmapFragment::create(center, QRectF(_glyphs.at(glyphOf(count))),
+        1.0 / _pixelRatio, 1.0 / _pixelRatio);
+}
+
+int MarkerAtlas::glyphOf(int count)
+{
+    // Dernier seuil atteint par le nombre de points
+    const int* threshold = std::upper_bound(kThresholds, kThresholds + kGlyphCount, count);
+    return qMax(0, int(threshold - kThresholds) - 1);
+}
@@ -0,0 +1,69 @@
+// markeratlas.h
+#ifndef MARKERATLAS_H
+#define MARKERATLAS_H
+
+#include <QColor>
+#include <QPainter>
+#include <QPixmap>
+#include <QPointF>
+#include <QRect>
+#include <QVector>
+
+/**
+ * @class MarkerAtlas
+ * @brief Symboles des marqueurs d'une couleur, rendus une fois dans une seule image.
+ *
+ * L'atlas contient le symbole d'un point isolé et celui de chaque classe de
+ * regroupement (2 à 9, puis 10+, 20+, 50+… jusqu'à 100k+). Les marqueurs
+ * sont ensuite dessinés par copies de fragments de l'atlas, en un seul
+ * appel (QPainter::drawPixmapFragments), sans dessin vectoriel ni texte.
+ */
+class MarkerAtlas {
+private:
+    QPixmap _pixmap; ///< Symboles côte à côte, en pixels physiques
+    QVector<QRect> _glyphs; ///< Emplacement de chaque symbole dans l'atlas, en pixels physiques
+    qreal _pixelRatio; ///< Pixels physiques par pixel logique
+
+public:
+    /**
+     * @brief Constructeur d'un atlas vide.
+     */
+    MarkerAtlas();
+
+    /**
+     * @brief Constructeur : rend tous les symboles d'une couleur.
+     * @param color Couleur des marqueurs
+     * @param pixelRatio Pixels physiques par pixel logique
+     */
+    MarkerAtlas(const QColor& color, qreal pixelRatio);
+
+    /**
+     * @brief Indique si l'atlas est vide.
+     * @return Vrai pour un atlas construit sans couleur
+     */
+    bool isNull() const;
+
+    /**
+     * @brief Récupère l'image de l'atlas.
+     * @return Image contenant tous les symboles
+     */
+    const QPixmap& pixmap() const;
+
+    /**
+     * @brief Prépare la copie du symbole d'un marqueur.
+     * @param center Centre du marqueur, en pixels logiques
+     * @param count Nombre de points représentés
+     * @return Fragment à passer à QPainter::drawPixmapFragments()
+     */
+    QPainter::PixmapFragment fragment(const QPointF& center, int count) const;
+
+private:
+    /**
+     * @brief Choisit le symbole d'un nombre de points.
+     * @param count Nombre de points représentés
+     * @return Rang du symbole dans l'atlas
+     */
+    static int glyphOf(int count);
+};
+
+#endif // MARKERATLAS_H
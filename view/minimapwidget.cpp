@@ -0,0 +1,233 @@
+// minimapwidget.cpp
+#include "minimapwidget.h"
+#include "model/projection.h"
+
+#include <QMouseEvent>
+#include <QPaintEvent>
+#include <QPainter>
+#include <QResizeEvent>
+#include <QtMath>
+#include <cmath>
+
+namespace {
+
+const int kZoomDelta = 4; ///< Niveaux de zoom entre la carte principale et la vue d'ensemble
+const double kTileSize = 256.0; ///< Taille d'une tuile dans le widget, en pixels logiques
+const double kRecenterMargin = 0.25; ///< Écart toléré entre le cadre et le centre, en fraction de la taille du widget
+const int kMaxFallbackDepth = 3; ///< Nombre maximal de niveaux remontés pour remplacer une tuile absente
+
+} // namespace
+
+MinimapWidget::MinimapWidget(MapModel* mapModel, MapController* mapController, QWidget* parent)
+    : QWidget(parent)
+    , _mapModel(mapModel)
+    , _mapController(mapController)
+    , _client(-1)
+    , _zoom(-1)
+{
+    // Suivre le centre et le zoom de la carte
+    connect(_mapModel, &MapModel::centerChanged, this, &MinimapWidget::onCenterChanged);
+    connect(_mapModel, &MapModel::zoomChanged, this, &MinimapWidget::onZoomChanged);
+
+    setCursor(Qt::PointingHandCursor);
+}
+
+MinimapWidget::~MinimapWidget()
+{
+    if (!_engine.isNull())
+        _engine->unsubscribe(_client);
+}
+
+void MinimapWidget::setTileEngine(const QSharedPointer<TileEngine>& engine)
+{
+    if (engine == _engine)
+        return;
+
+    if (!_engine.isNull()) {
+        _engine->unsubscribe(_client);
+        disconnect(_engine.data(), nullptr, this, nullptr);
+    }
+
+    // Les tuiles de la vue d'ensemble arrivent par le même moteur que celles de la carte
+    _engine = engine;
+    _client = _engine->subscribe();
+    connect(_engine.data(), &TileEngine::tileReady, this, &MinimapWidget::onTileReady);
+
+    // Le fond dessiné vient de l'ancienne source
+    _background = QPixmap();
+    updateViewRect();
+}
+
+void MinimapWidget::setViewSize(const QSize& size)
+{
+    _viewSize = size;
+    updateViewRect();
+}
+
+void MinimapWidget::onCenterChanged()
+{
+    updateViewRect();
+}
+
+void MinimapWidget::onZoomChanged()
+{
+    updateViewRect();
+}
+
+void MinimapWidget::updateViewRect()
+{
+    if (_engine.isNull() || width() <= 0 || height() <= 0)
+        return;
+
+    QPointF center = _mapModel->getCenter();
+    int zoom = qMax(_mapModel->getMinZoom(), _mapModel->getTileZoom() - kZoomDelta);
+    QPointF centerTile = Projection::lonLatToTile(center.x(), center.y(), zoom);
+
+    // Recentrer seulement si le niveau change ou si le cadre s'éloigne trop du centre
+    QPointF offset = (centerTile - _centerTile) * kTileSize;
+    bool recenter = zoom != _zoom || _background.isNull()
+        || std::abs(offset.x()) > width() * kRecenterMargin
+        || std::abs(offset.y()) > height() * kRecenterMargin;
+    if (recenter) {
+        _zoom = zoom;
+        _centerTile = centerTile;
+        offset = QPointF();
+        renderBackground();
+    }
+
+    // Le cadre a la taille de la carte divisée par l'écart d'échelle entre les deux vues
+    QSizeF viewSize = QSizeF(_viewSize) / std::pow(2.0, _mapModel->getZoom() - zoom);
+    QPointF viewCenter = QPointF(width(), height()) / 2.0 + offset;
+    QRectF previous = _viewRect;
+    _viewRect = QRectF(viewCenter - QPointF(viewSize.width(), viewSize.height()) / 2.0, viewSize);
+
+    // Sans recentrage, seules les anciennes et nouvelles positions du cadre sont redessinées
+    if (recenter)
+        update();
+    else
+        update(previous.united(_viewRect).toAlignedRect().adjusted(-2, -2, 2, 2));
+}
+
+void MinimapWidget::renderBackground()
+{
+    qreal ratio = devicePixelRatioF();
+    _background = QPixmap(size() * ratio);
+    _background.setDevicePixelRatio(ratio);
+    _background.fill(palette().color(QPalette::Mid));
+
+    // Plage de tuiles couverte par le widget, limitée aux tuiles valides
+    int n = 1 << _zoom;
+    QPointF topLeft = _centerTile - QPointF(width(), height()) / (2.0 * kTileSize);
+    QPointF bottomRight = topLeft + QPointF(width(), height()) / kTileSize;
+    _tileRange = QRect(QPoint(qFloor(topLeft.x()), qFloor(topLeft.y())),
+                     QPoint(qFloor(bottomRight.x()), qFloor(bottomRight.y())))
+                     .intersected(QRect(0, 0, n, n));
+
+    // Les tuiles en route pour la vue d'ensemble ne sont pas annulées par la carte
+    _engine->setRange(_client, _zoom, _tileRange);
+
+    QPainter painter(&_background);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    for (int y = _tileRange.top(); y <= _tileRange.bottom(); ++y) {
+        for (int x = _tileRange.left(); x <= _tileRange.right(); ++x) {
+            TileKey key { _zoom, x, y };
+            QImage tile = _engine->find(key);
+            if (!tile.isNull()) {
+                painter.drawImage(tileRect(key), tile);
+                continue;
+            }
+
+            // La tuile absente sera dessinée à son arrivée, via onTileReady()
+            drawFallback(painter, key);
+            _engine->load(key);
+        }
+    }
+}
+
+void MinimapWidget::drawFallback(QPainter& painter, const TileKey& key)
+{
+    for (int depth = 1; depth <= kMaxFallbackDepth && depth <= key.zoom; ++depth) {
+        TileKey parent { key.zoom - depth, key.x >> depth, key.y >> depth };
+        QImage image = _engine->find(parent);
+        if (image.isNull())
+            continue;
+
+        // Partie de la tuile parente couverte par la tuile absente
+        int mask = (1 << depth) - 1;
+        double part = double(image.width()) / (1 << depth);
+        QRectF source((key.x & mask) * part, (key.y & mask) * part, part, part);
+        painter.drawImage(tileRect(key), image, source);
+        return;
+    }
+}
+
+QRectF MinimapWidget::tileRect(const TileKey& key) const
+{
+    QPointF topLeft = QPointF(width(), height()) / 2.0 + (QPointF(key.x, key.y) - _centerTile) * kTileSize;
+    return QRectF(topLeft, QSizeF(kTileSize, kTileSize));
+}
+
+void MinimapWidget::onTileReady(const TileKey& key, const QImage& tile)
+{
+    if (_background.isNull() || key.zoom != _zoom || !_tileRange.contains(key.x, key.y))
+        return;
+
+    // Dessiner la tuile dans le fond et ne rafraîchir que sa zone
+    QPainter painter(&_background);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    painter.drawImage(tileRect(key), tile);
+    update(tileRect(key).toAlignedRect());
+}
+
+void MinimapWidget::jumpTo(const QPoint& pos)
+{
+    if (_zoom < 0)
+        return;
+
+    // Tuile sous le curseur, puis coordonnées géographiques
+    QPointF tile = _centerTile + (QPointF(pos) - QPointF(width(), height()) / 2.0) / kTileSize;
+    QPointF lonLat = Projection::tileToLonLat(tile, _zoom);
+
+    _mapController->setCenter(qBound(-180.0, lonLat.x(), 180.0),
+        qBound(-Projection::kMaxLatitude, lonLat.y(), Projection::kMaxLatitude));
+}
+
+void MinimapWidget::paintEvent(QPaintEvent* event)
+{
+    Q_UNUSED(event);
+
+    QPainter painter(this);
+    if (_background.isNull())
+        painter.fillRect(rect(), palette().color(QPalette::Mid));
+    else
+        painter.drawPixmap(0, 0, _background);
+
+    // Cadre de la zone affichée par la carte principale
+    if (!_viewRect.isEmpty()) {
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.setPen(QPen(QColor(200, 30, 30), 2));
+        painter.setBrush(QColor(200, 30, 30, 40));
+        painter.drawRect(_viewRect);
+    }
+}
+
+void MinimapWidget::resizeEvent(QResizeEvent* event)
+{
+    QWidget::resizeEvent(event);
+
+    // Le fond est redessiné à la nouvelle taille
+    _background = QPixmap();
+    updateViewRect();
+}
+
+void MinimapWidget::mousePressEvent(QMouseEvent* event)
+{
+    if (event->button() == Qt::LeftButton)
+        jumpTo(event->pos());
+}
+
+void MinimapWidget::mouseMoveEvent(QMouseEvent* event)
+{
+    if (event->buttons() & Qt::LeftButton)
+        jumpTo(event->pos());
+}
@@ -0,0 +1,152 @@
+// minimapwidget.h
+#ifndef MINIMAPWIDGET_H
+#define MINIMAPWIDGET_H
+
+#include "controller/mapcontroller.h"
+#include "model/mapmodel.h"
+#include "model/tileengine.h"
+#include <QImage>
+#include <QPixmap>
+#include <QPointF>
+#include <QRect>
+#include <QRectF>
+#include <QSharedPointer>
+#include <QSize>
+#include <QWidget>
+
+class QMouseEvent;
+class QPaintEvent;
+class QPainter;
+class QResizeEvent;
+
+/**
+ * @class MinimapWidget
+ * @brief Vue d'ensemble de la carte, quelques niveaux de zoom au-dessus de la vue principale.
+ *
+ * La vue d'ensemble encadre la zone affichée par la carte principale et
+ * permet d'y sauter d'un clic. Ses tuiles viennent du moteur de la carte
+ * (TileEngine), qu'elle suit quand la carte change de source : les tuiles
+ * de bas niveau sont presque toujours déjà en mémoire, et le peu qui
+ * manque passe après les tuiles de la carte.
+ *
+ * Le fond n'est redessiné qu'au changement de niveau, lorsque le cadre
+ * s'éloigne trop du centre, ou à l'arrivée d'une tuile : un déplacement de
+ * la carte ne redessine que le cadre.
+ */
+class MinimapWidget : public QWidget {
+    Q_OBJECT
+
+private:
+    MapModel* _mapModel; ///< Modèle de données pour la carte
+    MapController* _mapController; ///< Contrôleur pour les interactions avec la carte
+    QSharedPointer<TileEngine> _engine; ///< Moteur de tuiles partagé avec la carte principale
+    int _client; ///< Identifiant de la vue d'ensemble auprès du moteur, -1 sans moteur
+    int _zoom; ///< Niveau des tuiles affichées, -1 avant le premier dessin
+    QPointF _centerTile; ///< Tuile au centre du widget, en coordonnées fractionnaires au niveau affiché
+    QRect _tileRange; ///< Plage de tuiles couverte par le widget
+    QPixmap _background; ///< Tuiles déjà dessinées, réutilisées tant que la vue n'est pas recentrée
+    QSize _viewSize; ///< Taille de la carte principale, en pixels logiques
+    QRectF _viewRect; ///< Cadre de la zone affichée par la carte principale, en pixels du widget
+
+public:
+    /**
+     * @brief Constructeur de la vue d'ensemble.
+     * @param mapModel Modèle de données pour la carte
+     * @param mapController Contrôleur pour les interactions avec la carte
+     * @param parent Widget parent
+     */
+    MinimapWidget(MapModel* mapModel, MapController* mapController, QWidget* parent = nullptr);
+
+    /**
+     * @brief Destructeur : retire la vue d'ensemble du moteur de tuiles.
+     */
+    ~MinimapWidget() override;
+
+public slots:
+    /**
+     * @brief Passe au moteur de tuiles de la carte principale ; le fond est redessiné.
+     * @param engine Moteur de tuiles de la carte
+     */
+    void setTileEngine(const QSharedPointer<TileEngine>& engine);
+    /**
+     * @brief Définit la taille de la carte principale, qui fixe la taille du cadre.
+     * @param size Taille de la carte, en pixels logiques
+     */
+    void setViewSize(const QSize& size);
+
+    /**
+     * @brief Slot appelé lorsque le centre de la carte change.
+     */
+    void onCenterChanged();
+
+    /**
+     * @brief Slot appelé lorsque le niveau de zoom change.
+     */
+    void onZoomChanged();
+
+protected:
+    /**
+     * @brief Dessine le fond mis en cache puis le cadre de la vue principale.
+     * @param event Événement de dessin
+     */
+    void paintEvent(QPaintEvent* event) override;
+
+    /**
+     * @brief Gère le redimensionnement : le fond est redessiné à la nouvelle taille.
+     * @param event Événement de redimensionnement
+     */
+    void resizeEvent(QResizeEvent* event) override;
+
+    /**
+     * @brief Centre la carte principale sur le point cliqué.
+     * @param event Événement de clic de souris
+     */
+    void mousePressEvent(QMouseEvent* event) override;
+
+    /**
+     * @brief Fait suivre la carte principale au glissement de la souris, bouton enfoncé.
+     * @param event Événement de déplacement de souris
+     */
+    void mouseMoveEvent(QMouseEvent* event) override;
+
+private:
+    /**
+     * @brief Recalcule le cadre de la vue principale et recentre la vue d'ensemble si besoin.
+     */
+    void updateViewRect();
+
+    /**
+     * @brief Redessine le fond à partir des tuiles en mémoire et demande les tuiles absentes.
+     */
+    void renderBackground();
+
+    /**
+     * @brief Dessine à la place d'une tuile absente la partie agrandie d'une tuile parente en mémoire.
+     * @param painter Peintre du fond
+     * @param key Identifiant de la tuile absente
+     */
+    void drawFallback(QPainter& painter, const TileKey& key);
+
+    /**
+     * @brief Calcule l'emplacement d'une tuile dans le widget.
+     * @param key Identifiant de la tuile, au niveau affiché
+     * @return Rectangle de la tuile, en pixels du widget
+     */
+    QRectF tileRect(const TileKey& key) const;
+
+    /**
+     * @brief Centre la carte principale sur un point du widget.
+     * @param pos Position dans le widget
+     */
+    void jumpTo(const QPoint& pos);
+
+private slots:
+    /**
+     * @brief Slot appelé lorsque le moteur a décodé une tuile : dessinée si elle est dans le widget.
+     * @param key Identifiant de la tuile
+     * @param tile Tuile décodée
+     */
+    void onTileReady(const TileKey& key, const QImage& tile);
+};
+
+#endif // MINIMAPWIDGET_H
@@ -0,0 +1,245 @@
+// tilebackbuffer.cpp
+#include "tilebackbuffer.h"
+
+#include <QPainter>
+#include <QRegion>
+#include <QSemaphore>
+#include <QThreadPool>
+#include <cmath>
+#include <functional>
+
+namespace {
+
+/**
+ * @brief Calcule le reste positif de la division entière.
+ */
+int wrap(int value, int size)
+{
+    int r = value % size;
+    return r < 0 ? r + size : r;
+}
+
+/**
+ * @brief Interpole deux pixels ARGB32 prémultipliés, les quatre canaux à la fois.
+ * @param t Poids du second pixel, entre 0 et 256
+ */
+inline uint lerpPixel(uint a, uint b, uint t)
+{
+    // Rouge et bleu d'une part, alpha et vert d'autre part : 8 bits de marge par canal
+    uint rb = ((a & 0xff00ff) * (256 - t) + (b & 0xff00ff) * t) >> 8;
+    uint ag = (((a >> 8) & 0xff00ff) * (256 - t) + ((b >> 8) & 0xff00ff) * t) >> 8;
+    return (rb & 0xff00ff) | ((ag & 0xff00ff) << 8);
+}
+
+/**
+ * @brief Prépare l'échantillonnage d'un axe : pour chaque pixel de destination,
+ *        les deux positions voisines dans le tampon et le poids de la seconde.
+ */
+void sampleAxis(double origin, double scale, int first, int count, int validStart, int validEnd, int size,
+    QVector<int>& index0, QVector<int>& index1, QVector<uint>& weight)
+{
+    index0.resize(count);
+    index1.resize(count);
+    weight.resize(count);
+
+    for (int i = 0; i < count; i++) {
+        // Centre du pixel de destination, ramené au repère des centres de pixels du monde
+        double position = origin + (first + i + 0.5) / scale - 0.5;
+        int base = static_cast<int>(std::floor(position));
+        weight[i] = static_cast<uint>((position - base) * 256.0 + 0.5);
+        index0[i] = wrap(qBound(validStart, base, validEnd), size);
+        index1[i] = wrap(qBound(validStart, base + 1, validEnd), size);
+    }
+}
+
+} // namespace
+
+TileBackbuffer::TileBackbuffer(int margin)
+    : _zoom(-1)
+    , _margin(margin)
+    , _background(240, 240, 240)
+{
+}
+
+void TileBackbuffer::resize(const QSize& viewSize)
+{
+    QSize size = viewSize + QSize(2 * _margin, 2 * _margin);
+    if (_image.size() != size)
+        _image = QImage(size, QImage::Format_ARGB32_Premultiplied);
+    invalidate();
+}
+
+void TileBackbuffer::invalidate()
+{
+    _validRect = QRect();
+}
+
+QRect TileBackbuffer::validRect() const
+{
+    return _validRect;
+}
+
+qint64 TileBackbuffer::byteSize() const
+{
+    return _image.sizeInBytes();
+}
+
+QVector<QRect> TileBackbuffer::scrollTo(int zoom, const QRect& viewRect)
+{
+    if (_image.isNull())
+        return {};
+
+    // Rien à faire tant que la vue reste dans la zone couverte
+    if (zoom == _zoom && _validRect.contains(viewRect))
+        return {};
+
+    QRect oldRect = zoom == _zoom ? _validRect : QRect();
+
+    // Recentrer la zone couverte sur la vue
+    QRect newRect(QPoint(0, 0), _image.size());
+    newRect.moveCenter(viewRect.center());
+    _validRect = newRect;
+    _zoom = zoom;
+
+    // Seules les zones qui n'étaient pas déjà couvertes sont à redessiner
+    QVector<QRect> exposed;
+    QPainter painter(&_image);
+    for (const QRect& rect : QRegion(newRect).subtracted(QRegion(oldRect))) {
+        for (const QRect& piece : split(rect))
+            painter.fillRect(QRect(toBuffer(piece.topLeft()), piece.size()), _background);
+        exposed.append(rect);
+    }
+    return exposed;
+}
+
+void TileBackbuffer::draw(int zoom, const QRect& worldRect, const QPixmap& pixmap, const QRect& clip)
+{
+    draw(zoom, worldRect, pixmap, QRectF(pixmap.rect()), clip);
+}
+
+void TileBackbuffer::draw(int zoom, const QRect& worldRect, const QPixmap& pixmap, const QRectF& source, const QRect& clip)
+{
+    if (zoom != _zoom || worldRect.isEmpty())
+        return;
+
+    QRect area = worldRect.intersected(clip).intersected(_validRect);
+    if (area.isEmpty())
+        return;
+
+    // Rapport entre la taille de la partie d'image et celle de la zone recouverte
+    double scaleX = source.width() / worldRect.width();
+    double scaleY = source.height() / worldRect.height();
+    bool scaled = scaleX != 1.0 || scaleY != 1.0;
+
+    QPainter painter(&_image);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, scaled);
+    for (const QRect& piece : split(area)) {
+        QRectF pieceSource(source.x() + (piece.x() - worldRect.x()) * scaleX,
+            source.y() + (piece.y() - worldRect.y()) * scaleY,
+            piece.width() * scaleX, piece.height() * scaleY);
+        painter.drawPixmap(QRectF(QRect(toBuffer(piece.topLeft()), piece.size())), pixmap, pieceSource);
+    }
+}
+
+void TileBackbuffer::paint(QPainter& painter, const QPoint& target, const QRect& worldRect, int pixelRatio) const
+{
+    QRect area = worldRect.intersected(_validRect);
+    for (const QRect& piece : split(area)) {
+        QRect source(toBuffer(piece.topLeft()), piece.size());
+        if (pixelRatio == 1) {
+            painter.drawImage(target + (piece.topLeft() - worldRect.topLeft()), _image, source);
+            continue;
+        }
+
+        QPointF destination = QPointF(target) + QPointF(piece.topLeft() - worldRect.topLeft()) / pixelRatio;
+        painter.drawImage(QRectF(destination, QSizeF(piece.size()) / pixelRatio), _image, QRectF(source));
+    }
+}
+
+void TileBackbuffer::paintScaled(QImage& target, const QPointF& origin, double scale, const QRect& area) const
+{
+    QRect region = area.intersected(target.rect());
+    if (region.isEmpty() || _validRect.isEmpty() || scale <= 0.0)
+        return;
+
+    // Positions sources et poids calculés une fois par colonne et par ligne, bords du tampon compris
+    QVector<int> x0, x1, y0, y1;
+    QVector<uint> fx, fy;
+    sampleAxis(origin.x(), scale, region.left(), region.width(), _validRect.left(), _validRect.right(),
+        _image.width(), x0, x1, fx);
+    sampleAxis(origin.y(), scale, region.top(), region.height(), _validRect.top(), _validRect.bottom(),
+        _image.height(), y0, y1, fy);
+
+    // Pointeurs obtenus ici : scanLine() ne doit pas détacher l'image depuis les threads de travail
+    const uchar* sourceBits = _image.constBits();
+    qsizetype sourceStride = _image.bytesPerLine();
+    uchar* targetBits = target.bits();
+    qsizetype targetStride = target.bytesPerLine();
+    int width = region.width();
+
+    auto scaleRows = [&](int first, int last) {
+        for (int j = first; j < last; j++) {
+            const uint* row0 = reinterpret_cast<const uint*>(sourceBits + y0[j] * sourceStride);
+            const uint* row1 = reinterpret_cast<const uint*>(sourceBits + y1[j] * sourceStride);
+            uint* out = reinterpret_cast<uint*>(targetBits + (region.top() + j) * targetStride) + region.left();
+            uint weight = fy[j];
+            for (int i = 0; i < width; i++) {
+                uint top = lerpPixel(row0[x0[i]], row0[x1[i]], fx[i]);
+                uint bottom = lerpPixel(row1[x0[i]], row1[x1[i]], fx[i]);
+                out[i] = lerpPixel(top, bottom, weight);
+            }
+        }
+    };
+
+    // Une bande d'au moins 32 lignes par thread disponible, la première sur le thread appelant
+    QThreadPool* pool = QThreadPool::globalInstance();
+    int bands = qBound(1, region.height() / 32, pool->maxThreadCount() + 1);
+    int rowsPerBand = (region.height() + bands - 1) / bands;
+
+    QSemaphore done;
+    for (int band = 1; band < bands; band++) {
+        int first = band * rowsPerBand;
+        int last = qMin(region.height(), first + rowsPerBand);
+        std::function<void()> work = [&scaleRows, &done, first, last]() {
+            scaleRows(first, last);
+            done.release();
+        };
+
+        // Groupe saturé : calculer la bande ici plutôt que d'attendre une place
+        if (!pool->tryStart(work))
+            work();
+    }
+
+    scaleRows(0, qMin(region.height(), rowsPerBand));
+    done.acquire(bands - 1);
+}
+
+QVector<QRect> TileBackbuffer::split(const QRect& worldRect) const
+{
+    QVector<QRect> pieces;
+    if (worldRect.isEmpty())
+        return pieces;
+
+    // La zone étant incluse dans la zone couverte, elle franchit au plus un bord par axe
+    QPoint start = toBuffer(worldRect.topLeft());
+    int firstWidth = qMin(worldRect.width(), _image.width() - start.x());
+    int firstHeight = qMin(worldRect.height(), _image.height() - start.y());
+
+    int xs[2] = { worldRect.left(), worldRect.left() + firstWidth };
+    int ws[2] = { firstWidth, worldRect.width() - firstWidth };
+    int ys[2] = { worldRect.top(), worldRect.top() + firstHeight };
+    int hs[2] = { firstHeight, worldRect.height() - firstHeight };
+
+    for (int j = 0; j < 2; j++) {
+        for (int i = 0; i < 2; i++) {
+            if (ws[i] > 0 && hs[j] > 0)
+                pieces.append(QRect(xs[i], ys[j], ws[i], hs[j]));
+        }
+    }
+    return pieces;
+}
+
+QPoint TileBackbuffer::toBuffer(const QPoint& worldPos) const
+{
+    return QPoint(wrap(worldPos.x(), _image.width()), wrap(worldPos.y(), _image.height()));
+}
@@ -0,0 +1,143 @@
+// tilebackbuffer.h
+#ifndef TILEBACKBUFFER_H
+#define TILEBACKBUFFER_H
+
+#include <QColor>
+#include <QImage>
+#include <QPixmap>
+#include <QPointF>
+#include <QRect>
+#include <QVector>
+
+class QPainter;
+
+/**
+ * @class TileBackbuffer
+ * @brief Tampon de rendu torique à peine plus grand que la zone affichée.
+ *
+ * Le tampon couvre une zone du monde (en pixels au niveau de zoom courant)
+ * de la taille de la vue augmentée d'une marge. Un pixel du monde (x, y) est
+ * stocké en (x mod largeur, y mod hauteur) : faire défiler la vue revient à
+ * déplacer la zone couverte sans recopier les pixels, seules les bandes
+ * nouvellement exposées restant à dessiner.
+ *
+ * Pendant le zoom continu, la vue est affichée à une échelle différente de 1 :
+ * paintScaled() rééchantillonne alors le tampon en bilinéaire, en logiciel,
+ * en répartissant les lignes de l'image de destination sur plusieurs threads.
+ */
+class TileBackbuffer {
+private:
+    QImage _image; ///< Pixels du tampon, adressés modulo sa taille
+    QRect _validRect; ///< Zone du monde actuellement couverte par le tampon
+    int _zoom; ///< Niveau de zoom des pixels du tampon
+    int _margin; ///< Marge autour de la vue, en pixels
+    QColor _background; ///< Couleur des zones sans tuile
+
+public:
+    /**
+     * @brief Constructeur du tampon de rendu.
+     * @param margin Marge autour de la vue, en pixels
+     */
+    explicit TileBackbuffer(int margin = 256);
+
+    /**
+     * @brief Adapte le tampon à la taille de la vue et l'invalide.
+     * @param viewSize Taille de la vue en pixels
+     */
+    void resize(const QSize& viewSize);
+
+    /**
+     * @brief Invalide tout le contenu du tampon.
+     */
+    void invalidate();
+
+    /**
+     * @brief Récupère la zone du monde couverte par le tampon.
+     * @return Zone couverte, vide si le tampon est invalide
+     */
+    QRect validRect() const;
+
+    /**
+     * @brief Récupère la mémoire occupée par le tampon.
+     * @return Occupation en octets
+     */
+    qint64 byteSize() const;
+
+    /**
+     * @brief Fait défiler le tampon pour qu'il couvre une zone de la vue.
+     *
+     * Si la zone demandée sort de la zone couverte, le tampon est recentré sur
+     * elle ; les zones nouvellement exposées sont remplies avec la couleur de
+     * fond et renvoyées pour être redessinées.
+     * @param zoom Niveau de zoom de la vue
+     * @param viewRect Zone du monde affichée, en pixels
+     * @return Zones du monde à redessiner
+     */
+    QVector<QRect> scrollTo(int zoom, const QRect& viewRect);
+
+    /**
+     * @brief Dessine une image placée dans le monde, limitée à une zone.
+     *
+     * Le dessin est ignoré si le tampon couvre un autre niveau de zoom.
+     * @param zoom Niveau de zoom de l'image
+     * @param worldRect Emplacement de l'image dans le monde (taille de l'image)
+     * @param pixmap Image à dessiner
+     * @param clip Zone du monde à laquelle limiter le dessin
+     */
+    void draw(int zoom, const QRect& worldRect, const QPixmap& pixmap, const QRect& clip);
+
+    /**
+     * @brief Dessine une partie d'image mise à l'échelle d'une zone du monde, limitée à une zone.
+     *
+     * Le dessin est ignoré si le tampon couvre un autre niveau de zoom.
+     * @param zoom Niveau de zoom de la zone de destination
+     * @param worldRect Zone du monde recouverte par la partie d'image
+     * @param pixmap Image à dessiner
+     * @param source Partie de l'image à dessiner
+     * @param clip Zone du monde à laquelle limiter le dessin
+     */
+    void draw(int zoom, const QRect& worldRect, const QPixmap& pixmap, const QRectF& source, const QRect& clip);
+
+    /**
+     * @brief Dessine une zone du monde couverte par le tampon.
+     *
+     * Sur un écran haute densité, un pixel du tampon est un pixel physique :
+     * la zone est dessinée réduite du rapport de pixels, sans agrandissement.
+     * @param painter Peintre de destination
+     * @param target Position de destination, en pixels logiques
+     * @param worldRect Zone du monde à dessiner
+     * @param pixelRatio Nombre de pixels du monde par pixel logique
+     */
+    void paint(QPainter& painter, const QPoint& target, const QRect& worldRect, int pixelRatio = 1) const;
+
+    /**
+     * @brief Rééchantillonne le tampon à une échelle donnée dans une image.
+     *
+     * Le pixel (x, y) de l'image correspond au point du monde
+     * origin + (x, y) / scale ; les points hors de la zone couverte reprennent
+     * le bord le plus proche. Le calcul est réparti par bandes de lignes sur
+     * le groupe de threads global.
+     * @param target Image de destination (format ARGB32 prémultiplié)
+     * @param origin Point du monde affiché au coin supérieur gauche de l'image
+     * @param scale Échelle d'affichage (pixels de l'image par pixel du monde)
+     * @param area Partie de l'image à calculer
+     */
+    void paintScaled(QImage& target, const QPointF& origin, double scale, const QRect& area) const;
+
+private:
+    /**
+     * @brief Découpe une zone du monde selon les bords du tampon.
+     * @param worldRect Zone du monde (incluse dans la zone couverte)
+     * @return Morceaux de la zone, chacun contigu dans le tampon (au plus 4)
+     */
+    QVector<QRect> split(const QRect& worldRect) const;
+
+    /**
+     * @brief Convertit un point du monde en position dans le tampon.
+     * @param worldPos Point du monde
+     * @return Position dans le tampon
+     */
+    QPoint toBuffer(const QPoint& worldPos) const;
+};
+
+#endif // TILEBACKBUFFER_H
@@ -0,0 +1,106 @@
+// tilecompositor.cpp
+#include "tilecompositor.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define COMPOSITOR_SSE2
+#endif
+
+namespace {
+
+/**
+ * @brief Multiplie les quatre canaux d'un pixel ARGB32 par un facteur, avec arrondi.
+ * @param a Facteur, entre 0 et 255
+ */
+inline quint32 byteMul(quint32 pixel, quint32 a)
+{
+    // Rouge et bleu d'une part, alpha et vert d'autre part ; division par 255 arrondie
+    quint32 rb = (pixel & 0xff00ff) * a;
+    rb = ((rb + ((rb >> 8) & 0xff00ff) + 0x800080) >> 8) & 0xff00ff;
+    quint32 ag = ((pixel >> 8) & 0xff00ff) * a;
+    ag = (ag + ((ag >> 8) & 0xff00ff) + 0x800080) & 0xff00ff00;
+    return rb | ag;
+}
+
+#ifdef COMPOSITOR_SSE2
+
+/**
+ * @brief Multiplie des canaux de 16 bits par des facteurs, avec le même arrondi que byteMul().
+ * @param channels Canaux, entre 0 et 255
+ * @param factors Facteurs, entre 0 et 255
+ */
+inline __m128i byteMul16(__m128i channels, __m128i factors)
+{
+    __m128i product = _mm_mullo_epi16(channels, factors);
+    product = _mm_add_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), _mm_set1_epi16(0x80));
+    return _mm_srli_epi16(product, 8);
+}
+
+/**
+ * @brief Calcule le complément de l'alpha de deux pixels, répété sur leurs quatre canaux.
+ * @param channels Canaux de deux pixels, sur 16 bits
+ */
+inline __m128i inverseAlpha16(__m128i channels)
+{
+    __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(channels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    return _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+}
+
+#endif // COMPOSITOR_SSE2
+
+} // namespace
+
+void TileCompositor::blend(QImage& target, const QImage& layer, double opacity)
+{
+    if (layer.isNull())
+        return;
+
+    quint32 alpha = static_cast<quint32>(qBound(0.0, opacity, 1.0) * 255.0 + 0.5);
+    if (alpha == 0)
+        return;
+
+    if (target.format() != QImage::Format_ARGB32_Premultiplied)
+        target = target.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    QImage source = layer.format() == QImage::Format_ARGB32_Premultiplied
+        ? layer
+        : layer.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+
+    // Calque sans tuiles haute densité sur un fond « @2x » : la tuile du calque est agrandie
+    if (source.size() != target.size())
+        source = source.scaled(target.size(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+
+    for (int y = 0; y < target.height(); y++) {
+        blendRow(reinterpret_cast<quint32*>(target.scanLine(y)),
+            reinterpret_cast<const quint32*>(source.constScanLine(y)), target.width(), alpha);
+    }
+}
+
+void TileCompositor::blendRow(quint32* __restrict target, const quint32* __restrict layer, int count, quint32 alpha)
+{
+    // Pas de cas particulier pour les pixels transparents ou opaques : aucune branche par pixel
+    int i = 0;
+#ifdef COMPOSITOR_SSE2
+    // Quatre pixels à la fois, canaux étendus sur 16 bits ; la somme finale se fait sur les
+    // pixels de 32 bits, comme la version scalaire
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i layerAlpha = _mm_set1_epi16(short(alpha));
+    for (; i + 4 <= count; i += 4) {
+        __m128i layerPixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(layer + i));
+        __m128i targetPixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(target + i));
+
+        __m128i sourceLow = byteMul16(_mm_unpacklo_epi8(layerPixels, zero), layerAlpha);
+        __m128i sourceHigh = byteMul16(_mm_unpackhi_epi8(layerPixels, zero), layerAlpha);
+        __m128i targetLow = byteMul16(_mm_unpacklo_epi8(targetPixels, zero), inverseAlpha16(sourceLow));
+        __m128i targetHigh = byteMul16(_mm_unpackhi_epi8(targetPixels, zero), inverseAlpha16(sourceHigh));
+
+        __m128i blended = _mm_add_epi32(_mm_packus_epi16(sourceLow, sourceHigh), _mm_packus_epi16(targetLow, targetHigh));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(target + i), blended);
+    }
+#endif
+
+    // Fin de ligne, ou ligne entière sans SSE2
+    for (; i < count; i++) {
+        quint32 source = byteMul(layer[i], alpha);
+        target[i] = source + byteMul(target[i], 255 - (source >> 24));
+    }
+}
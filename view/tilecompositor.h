@@ -0,0 +1,37 @@
+// tilecompositor.h
+#ifndef TILECOMPOSITOR_H
+#define TILECOMPOSITOR_H
+
+#include <QImage>
+
+/**
+ * @class TileCompositor
+ * @brief Superposition des tuiles des calques sur la tuile du fond de carte.
+ *
+ * Les images sont au format ARGB32 prémultiplié. Chaque ligne est mélangée
+ * (opérateur « source over ») par une boucle sans branchement sur des
+ * entiers : quatre pixels à la fois avec SSE2, un par un sur les autres
+ * processeurs, avec des résultats identiques.
+ */
+class TileCompositor {
+public:
+    /**
+     * @brief Dessine une tuile de calque par-dessus une tuile.
+     * @param target Tuile de destination, convertie en ARGB32 prémultiplié si besoin
+     * @param layer Tuile du calque, mise à la taille de la destination si besoin
+     * @param opacity Opacité du calque, entre 0 et 1
+     */
+    static void blend(QImage& target, const QImage& layer, double opacity);
+
+private:
+    /**
+     * @brief Mélange une ligne de pixels ARGB32 prémultipliés.
+     * @param target Pixels de destination
+     * @param layer Pixels du calque
+     * @param count Nombre de pixels
+     * @param alpha Opacité du calque, entre 0 et 255
+     */
+    static void blendRow(quint32* __restrict target, const quint32* __restrict layer, int count, quint32 alpha);
+};
+
+#endif // TILECOMPOSITOR_H